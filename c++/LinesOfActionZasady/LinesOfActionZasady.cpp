@@ -3,6 +3,7 @@
 #include "object_pool.h"
 #include "object_pool_multisize.h"
 #include "random_generator.h"
+#include "static_mcts.h"
 #include <algorithm>
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS  
 #include <intrin.h> 
@@ -330,7 +331,7 @@ struct GameState
 
 namespace LinesOfAction
 {
-	struct LinesOfActionGameRules : IGameRules
+	struct LinesOfActionGameRules final : IGameRules
 	{
 		static const int NumPlayers = 2;
 		int m_RefCnt;
@@ -363,9 +364,12 @@ namespace LinesOfAction
 			gs->white = 0x0081818181818100;
 			return gs;
 		}
-		GameState* CreateInitialStateFromHash(const uint32_t*) override
+		GameState* CreateInitialStateFromHash(const uint32_t* hash) override
 		{
-			throw "not implemented";
+			//hash is the raw state, see GetStateHash
+			auto* gs = allocGameState();
+			memcpy(gs, hash, sizeof(GameState));
+			return gs;
 		}
 		GameState* CreateStateFromString(const wstring&) override
 		{
@@ -548,4 +552,13 @@ IGameRules* createLinesOfActionGameRules()
 BOOST_DLL_ALIAS(
 	createLinesOfActionGameRules,	// <-- this function is exported with...
 	createGameRules					// <-- ...this alias name
+)
+//mcts player calling these rules directly, without virtual dispatch
+IGamePlayer* createLinesOfActionStaticPlayer(int player_number, const PlayerConfig_t& pc)
+{
+	return new MC::StaticPlayer<LinesOfAction::LinesOfActionGameRules>(MC::makeStaticSearchConfig(player_number, pc), std::make_unique<LinesOfAction::LinesOfActionGameRules>());
+}
+BOOST_DLL_ALIAS(
+	createLinesOfActionStaticPlayer,	// <-- this function is exported with...
+	createPlayer						// <-- ...this alias name
 )
\ No newline at end of file
@@ -2,15 +2,15 @@
 #include "GamePlayer.h"
 #include "GameRules.h"
 #include "object_pool_multisize.h"
+#include "policy_table.h"
 #include <random>
 #include <codecvt>
 #include <iostream>
 #include <fstream>
 #include <set>
+#include <memory>
 #define ENABLE_TRACE
 #include <Trace.h>
-#include <boost/xpressive/xpressive.hpp>
-using namespace boost::xpressive;
 using namespace Trace;
 
 namespace MCRL
@@ -82,6 +82,12 @@ namespace MCRL
 
 			return { node,move_list };
 		}
+		//bytes of the node without state hash, as stored in the policy file
+		size_t recordBytes() const
+		{
+			return sizeof(StateNode) + (numMoves - 1) * sizeof(MoveNode);
+		}
+		//valid only for nodes created by create, nodes mapped from the policy file have no hash
 		uint32_t* getStateHash()
 		{
 			return reinterpret_cast<uint32_t*>(&moves[numMoves]);
@@ -134,6 +140,9 @@ namespace MCRL
 			m_game_rules = gr;
 			gr->AddRef();
 			StateNode::HashSize = m_game_rules->GetStateHashSize();
+			if (!m_cfg.policyFilename.empty()) {
+				loadState(m_cfg.policyFilename);
+			}
 		}
 
 		MoveList*	selectMove(GameState* pks) override
@@ -142,12 +151,16 @@ namespace MCRL
 				return m_game_rules->GetPlayerLegalMoves(pks, m_cfg.PlayerNumber);
 			}
 			//string sth = m_game_rules->ToString(gs);
-			auto it = m_visitedStates.find({m_game_rules->GetStateHash(pks), nullptr});
+			const uint32_t *state_hash = m_game_rules->GetStateHash(pks);
+			auto it = m_visitedStates.find({state_hash, nullptr});
+			StateNode *stateNode = it != m_visitedStates.end() ? it->node : nullptr;
+			if (!stateNode && m_policy) {
+				stateNode = reinterpret_cast<StateNode*>(m_policy->find(state_hash));
+			}
 			int selectedMoveIdx;
-			StateNode *stateNode;
 			MoveList *moves;
 			
-			if (it == m_visitedStates.end())
+			if (!stateNode)
 			{
 				auto [sn,ml] = StateNode::create(pks, m_game_rules);
 				stateNode = sn;
@@ -159,7 +172,6 @@ namespace MCRL
 			}
 			else
 			{
-				stateNode = it->node;
 				selectedMoveIdx = selectMove(stateNode, m_cfg.EERatio);
 				moves = m_game_rules->GetPlayerLegalMoves(pks, m_cfg.PlayerNumber);
 			}
@@ -196,7 +208,8 @@ namespace MCRL
 		IGameRules*	m_game_rules;
 		Path_t		m_currentPath;
 		//std::map<string, StateNode*> m_visitedStates;
-		std::set<StateNodeRef> m_visitedStates;
+		std::set<StateNodeRef> m_visitedStates;	//states not in the policy file yet
+		std::unique_ptr<PolicyTable> m_policy;
 		std::default_random_engine	m_generator;
 		ITrace			*m_trace;
 	};
@@ -257,45 +270,28 @@ namespace MCRL
 		return distribution(m_generator);
 	}
 
+	//statistics of mapped states are already in the file, new states are appended and released
 	void Player::saveState(string filename)
 	{
-		//std::wofstream out(filename);
-		//std::locale loc(std::locale::classic(), new std::codecvt_utf8<wchar_t>);
-		//out.imbue(loc);
-		std::ofstream out(filename);
+		if (!m_policy) loadState(filename);
+		m_policy->flush();
+		//game in progress keeps pointers to the nodes
+		if (!m_currentPath.empty() || m_visitedStates.empty()) return;
 
-		for (auto kv : m_visitedStates)
-		{
-			auto *sn = kv.node;
-			auto *gs = m_game_rules->CreateInitialStateFromHash(kv.hash);
-			out << "state ";
-			auto *sh = sn->getStateHash();
-			for (size_t i=0;i<StateNode::HashSize; ++i) {
-				out << *sh++ << " ";
-			}
-			out << " visited " << sn->numVisited << " moves " << sn->numMoves << std::endl;
-			m_game_rules->ReleaseGameState(gs);
-			for (unsigned mi=0;mi<sn->numMoves;++mi) {
-				out << "move idx " << sn->moves[mi].moveIdx << " visited " << sn->moves[mi].numVisited << " value " << sn->moves[mi].accum << std::endl;
-			}
+		std::vector<PolicyRecordRef> records;
+		records.reserve(m_visitedStates.size());
+		for (auto kv : m_visitedStates) {
+			records.push_back({ kv.hash, reinterpret_cast<const uint8_t*>(kv.node), kv.node->recordBytes() });
 		}
+		m_policy->append(std::move(records));
+		releaseStateNodes();
+		m_visitedStates.clear();
 	}
 
+	//file is mapped, states are read by lookups during the games
 	void Player::loadState(string filename)
 	{
-		std::ifstream input(filename);
-		std::string line;
-		sregex state_regex = "state ">>(s1=+_d)>>' '>>(s2=+_d)>>' '>>(s3 = +_d)>>" visited ">>(s4=+_d)>>" moves ">>(s5=+_d);
-		sregex move_regex = "move idx ">>(s1=+_d)>>" visited ">>(s2=+_d)>>" value ">>(s3=+(_d|'.'));
-		smatch what;
-
-		while (std::getline(input, line))
-		{
-			if (regex_match(line, what, state_regex))
-			{
-			}
-			
-		}
+		m_policy = std::make_unique<PolicyTable>(filename, uint32_t(StateNode::HashSize));
 	}
 
 	IGamePlayer* createMCRLPlayer(int player_number, const PlayerConfig_t& pc)
@@ -2,10 +2,19 @@
 #include <string>
 #include <random>
 #include <set>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <thread>
 #include "GamePlayer.h"
 #include "GameRules.h"
-#include "object_pool_multisize.h"
-#include <boost/bimap.hpp>
+#include "node_arena.h"
+#include "reclaim_queue.h"
+#include "state_hash_table.h"
+#include "path_set.h"
+#include "opening_book.h"
+#include "shared_root_stats.h"
+#include "search_profile.h"
 #include "Trace.h"
 
 struct Move;
@@ -32,26 +41,84 @@ namespace MC
 		float		WeightedBackprop;
 		string		EvalFcn;
 		string		Name;
+		int			SearchThreads = 1;
+		bool		TreeParallel = false;	//false: every search thread grows its own tree, true: all threads share single tree
+		int			VirtualLoss = 1;		//number of visits added to the move while it is being simulated in tree parallel mode
+		bool		BackgroundReclaim = false;	//discarded nodes are released by a background thread, needs private rules instance
+		bool		LightRollout = false;	//playout past the nodes kept by expansion does not create tree nodes
+		bool		Ponder = false;			//search continues in background during opponents' turns, needs private rules instance
+		int			PonderMaxSimulations = 100000;	//limit of simulations during single opponent's turn
+		size_t		MaxTreeBytes = 0;		//node memory budget, 0 : unlimited
+		size_t		MaxNodes = 0;			//number of nodes budget, 0 : unlimited
+		string		OpeningBookFilename;	//new nodes get move statistics of the book as priors
+		int			OpeningBookMaxVisits = 100;	//book statistics are scaled down to this number of node visits
+		int			EvalBatchSize = 1;		//non-terminal leaves evaluated together, above 1 search runs in tree parallel mode
+		bool		Solver = false;			//game values proven by terminal states are propagated up the tree, proven nodes are not simulated through
+		bool		LazyExpansion = false;	//new node keeps only its state until it is visited again, nodes below the root do not keep move lists
+		bool		InformationSetSearch = false;	//every simulation plays a sampled complete state, tree nodes stand for what PlayerNumber knows
+		string		SharedStatsFilename;	//root statistics are exchanged through this file with other processes searching the same position
+		int			SharedStatsSlot = 0;	//0 : coordinator merging statistics of the other processes for its move, 1.. : worker process publishing them
+		int			SharedStatsProcesses = 1;	//number of slots in the file, coordinator included
+		int			SharedStatsInterval = 1000;	//simulations between two publishes of root statistics
+	};
+	//visits of the move search would select now minus visits of the most visited other root move
+	//lead is negative when selected move is not the most visited one
+	struct RootLead
+	{
+		long	lead;
+		long	root_visits;
 	};
 	struct IMoveLimit
 	{
 		virtual void start() = 0;
 		virtual bool can_continue() = 0;
 		virtual void release() = 0;
+		//hooks for limits adapting to the game, simple limits ignore them
+		virtual void startGame() {}
+		virtual void endGame() {}
+		virtual void startMove(int root_moves, float average_branching_factor) { start(); }
+		virtual void setRootLead(std::function<RootLead()> root_lead) {}
+		virtual void getStats(NamedMetrics_t& nm) const {}
 	protected:
 		virtual ~IMoveLimit() {}
 	};
 
-	struct StateNode;
+	template <int NP, typename Counter> struct StateNodeT;
 	struct ValidMoveList;
-#pragma pack (push,1)
-	struct MoveNode
+	//child pointer appended by one searcher and followed by the others without lock during tree parallel search
+	//reads acquire and writes release, reader sees the node fully initialized; on x86 both compile to plain moves
+	//copies keep MoveNode copyable, they are made only while no other searcher writes the node
+	template <typename T>
+	struct NodePtr
 	{
-		StateNode		*next;		//8
-		unsigned char	numVisited;	//1
-		unsigned char	moveIdx;	//1
+		NodePtr(T* p = nullptr) : ptr(p) {}
+		NodePtr(const NodePtr& other) : ptr(other.load()) {}
+		NodePtr& operator=(const NodePtr& other) { return *this = other.load(); }
+		NodePtr& operator=(T* p)
+		{
+			ptr.store(p, std::memory_order_release);
+			return *this;
+		}
+		T* load() const { return ptr.load(std::memory_order_acquire); }
+		operator T*() const { return load(); }
+		T* operator->() const { return load(); }
+	private:
+		std::atomic<T*>	ptr;
+	};
+	//NP : number of players which values are kept, Counter : type of visit counters
+	//fields are ordered by size, natural alignment keeps next 8 byte aligned, it is read without locking during tree parallel search
+	//NP=2 gives 24 bytes, NP=4 gives 32 bytes
+	template <int NP, typename Counter>
+	struct MoveNodeT
+	{
+		static const int NumPlayers = NP;
+		using Counter_t = Counter;
+
+		NodePtr<StateNodeT<NP, Counter>>	next;	//8
+		float			value[NP];	//4*NP
+		Counter			numVisited;	//2 or 4
 		unsigned short	probability;//2
-		float			value[4];	//16
+		unsigned char	moveIdx;	//1
 		float getWeight(int player) const {
 			//return numVisited != 0 ? value[player] * probability / numVisited : 0;
 			return value[player] * get_probability() / (1.0f + numVisited);
@@ -69,25 +136,59 @@ namespace MC
 		}
 	};
 
-	struct StateNode
+#pragma pack (push,1)
+	template <int NP, typename Counter>
+	struct StateNodeT
 	{
+		using MoveNode = MoveNodeT<NP, Counter>;
+
 		GameState*		state;			//8
-		MoveList*		moveList;		//8
+		MoveList*		moveList;		//8 nullptr when moves are derived again from the state on demand
 		int				numVisited;		//4
 		unsigned char	currentPlayer;	//1
 		unsigned char	occured : 1;	//1bit 1 means this state occured during real game
 		unsigned char	terminal : 1;	//1bit
 		unsigned char	temporary : 1;	//1 : 0=this state is part of the game tree, 1=created during playout, not yet included
-		unsigned char	occupied;		//1
-		unsigned short	lastVisitId;	//2
+		unsigned char	proven : 1;		//1bit game value is known, kept in provenScore
+		unsigned char	unexpanded : 1;	//1bit moves not generated yet, room of the first move holds link from the only parent
+		unsigned char	occupied;		//1 0=free, 1=in use, 2=moved to next generation arena, state holds new address
+		unsigned short	lastVisitId;	//2 used by tree walks, simulations keep their path in PathSet and do not write it
 		unsigned char	numMoves;		//1
-		unsigned char	pad[2];			//4
+		unsigned char	owner;			//1 index of the searcher which rules instance allocated state and moveList
+		signed char		provenScore[4];	//4 score of every player when proven
+		unsigned char	pad[1];			//1
 		MoveNode		moves[1];		//next will follow
 
+		static const int WinScore = 100;
+		float provenValue(int player) const { return provenScore[player] / 100.0f; }
+
 		void free(IGameRules *gr);
-		std::tuple<MoveNode*, Move*, StateNode*> getBestMove(IGameRules *gr);
-		ValidMoveList* listValidMoves(unsigned short visit_id, std::function<ValidMoveList*(int)> alloc) const;
-		static StateNode* create(GameState*, IGameRules* gameRules, std::function<StateNode*(int)>);
+		std::tuple<MoveNode*, Move*, StateNodeT*> getBestMove(IGameRules *gr);
+		ValidMoveList* listValidMoves(const PathSet<StateNodeT>& path_nodes, ValidMoveList* vml) const;
+		static StateNodeT* create(GameState*, IGameRules* gameRules, std::function<StateNodeT*(int)>, bool keep_move_list = true);
+		static StateNodeT* createUnexpanded(GameState*, IGameRules* gameRules, std::function<StateNodeT*(int)>);
+		MoveNode*& parentLink() { return *reinterpret_cast<MoveNode**>(moves); }
+		//node without moves keeps room for one, so a freed node can hold the free list link and the forwarding address
+		static size_t bytes(int number_of_moves) { return offsetof(StateNodeT, moves) + __max(1, number_of_moves) * sizeof(MoveNode); }
+	};
+
+	//move list of a node which does not keep its own is derived again from the state for the time of the lookup
+	//rules list moves of equal states in the same order, so moveIdx always denotes the same move
+	struct ScopedMoveList
+	{
+		template <typename StateNode>
+		ScopedMoveList(IGameRules* gr, const StateNode* sn) : gr(gr), list(sn->moveList), owned(nullptr == sn->moveList)
+		{
+			if (owned) list = gr->GetPlayerLegalMoves(sn->state, sn->currentPlayer);
+		}
+		~ScopedMoveList() { if (owned) gr->ReleaseMoveList(list); }
+		ScopedMoveList(const ScopedMoveList&) = delete;
+		ScopedMoveList& operator=(const ScopedMoveList&) = delete;
+		std::tuple<Move*, float> get(int move_idx) const { return gr->GetMoveFromList(list, move_idx); }
+
+		IGameRules	*gr;
+		MoveList	*list;
+		bool		owned;
 	};
 
 	struct ValidMoveList
@@ -116,37 +217,124 @@ namespace MC
 	};
 #pragma pack(pop)
 
-	using Path_t = std::vector< std::pair<MC::StateNode*, MoveNode*> >;
+	//default instantiation : up to 4 players, 32 bit visit counters
+	using MoveNode = MoveNodeT<4, uint32_t>;
+	using StateNode = StateNodeT<4, uint32_t>;
+	using Path_t = std::vector< std::pair<StateNode*, MoveNode*> >;
 	using CLK = std::chrono::high_resolution_clock;
-	struct Player : IGamePlayer
+	struct RolloutResult
+	{
+		int			score[4];
+		float		discount;		//applied to score before backpropagation, product of move weights along the rollout
+		bool		evaluated;		//false when playout ended in a tree node, which is then evaluated by backpropagation
+	};
+	struct MergedMoveStats
 	{
+		double		value[4];
+		unsigned	numVisited;
+		float		probability;
+		float getWeight(int player) const {
+			return float(value[player] * probability / (1.0 + numVisited));
+		}
+	};
+	template <int NP, typename Counter>
+	struct PlayerT : IGamePlayer
+	{
+		using MoveNode = MoveNodeT<NP, Counter>;
+		using StateNode = StateNodeT<NP, Counter>;
+		using Path_t = std::vector< std::pair<StateNode*, MoveNode*> >;
+
 		const MCTSConfig	m_cfg;
 		EvalFunction_t	m_eval_function;
+		BatchEvalFunction_t	m_batch_eval_function;
 		IMoveLimit		*m_mv_limit;
 		ITrace			*m_trace;
-		IGameRules		*m_game_rules;
+		IGameRules		*m_game_rules = nullptr;
+		IGameRules		*m_shared_rules = nullptr;	//instance shared with the game controller, differs from m_game_rules when reclaiming in background
 		StateNode		*m_root = nullptr;
 		StateNode		*m_super_root = nullptr;
+		StateNode		*m_reclaim_root = nullptr;	//previous root, nodes reachable from it but not from m_root wait for release
 		std::default_random_engine	m_generator;
-		ObjectPoolMultisize<4 * sizeof(MoveNode), 4096> m_nodePool;					//1 chunk = 1 statenode + 4 moves
-		ObjectPoolMultisize<2 * sizeof(ValidMoveList), 16384> m_validMoveListPool;	//1 chunk = 3 moves
+		using NodeArena_t = NodeArena<8, 256 * 1024>;				//node takes StateNode::bytes rounded up to whole slots
+		NodeArena_t		m_nodeArena;
+		std::vector<std::unique_ptr<NodeArena_t>>	m_spare_arenas;	//nodes surviving root change are copied to spare arena, then arenas are swapped
+		std::mutex		m_spare_arenas_mutex;
+		std::unique_ptr<ReclaimQueue>	m_own_reclaim_queue;
+		ReclaimQueue	*m_reclaim_queue = nullptr;	//workers share main player's queue
+		//simulation buffers are sized from MaxPlayoutDepth once, selection, backpropagation and expansion reuse them
+		static const int MaxMoves = 256;		//StateNode::numMoves is 8 bit
+		static const size_t ValidMoveListStride = sizeof(ValidMoveList) + MaxMoves;
+		Path_t			m_path;
+		std::vector<uint8_t>	m_valid_moves;	//valid move list for every path position, ValidMoveListStride bytes each
+		std::vector<StateNode*>	m_to_be_freed;	//temporary nodes dropped by expansion
 		int				m_move_nbr = 1;
 		int				m_game_nbr = 1;
 		Histogram<long>	m_nodePool_usage;
+		Average<float>	m_nodePool_fragmentation;
+		Average<float>	m_allocations_per_simulation;
+		Histogram<long>	m_reclaim_queue_length;
 		Histogram<long> m_num_runs_per_move;
 		Histogram<string>	m_find_root_node_result;
 		Histogram<long> m_simulation_end_node;
 		Histogram<long> m_best_move_is_most_visited;
 		Histogram<long> m_branching_factor;
 		Histogram<long> m_path_size;
+		Histogram<long> m_simulations_per_sec;
+		Average<float>	m_state_table_probe_length;
+		Average<float>	m_state_table_load_factor;
 		const bool		m_release_nodes_during_find;
-		using StatesBimap = boost::bimap<boost::bimaps::set_of<string>, boost::bimaps::set_of<StateNode*>>;
-		StatesBimap		m_states_in_game_tree;
-		unsigned short	m_curr_visit_id = 0;
+		std::vector<PlayerT*>	m_workers;				//parallel search, in root mode each worker grows its own tree
+		PlayerT					*m_tree_owner;			//player owning the searched tree, this unless worker in tree parallel mode
+		unsigned char			m_searcher_idx = 0;		//0 for main player, 1.. for workers
+		std::mutex				m_tree_mutex;			//tree parallel mode : guards node creation and m_states_in_game_tree
+		std::array<std::mutex, 64>	m_stat_locks;		//tree parallel mode : striped locks guarding MoveNode and StateNode statistics
+		CreateGameRules_t		m_create_game_rules;	//used to create private rules instance for every worker
+		StateHashTable<StateNode>	m_states_in_game_tree;	//state digest -> node, index of all states in the tree
+		std::atomic<unsigned short>	m_curr_visit_id{ 0 };
+		PathSet<StateNode>		m_path_nodes;			//nodes visited by current simulation, including dead ends it backtracked from
+		std::thread				m_ponder_thread;
+		std::atomic<bool>		m_ponder_stop{ false };
+		std::atomic<bool>		m_ponder_done{ false };	//pondering thread finished its simulations, set before it exits
+		std::vector<Counter>	m_ponder_start_visits;	//visits of root moves when pondering started
+		long					m_ponder_start_root_visits = 0;
+		std::vector<std::pair<const GameState*, long>>	m_pondered_states;	//root and its children with simulations pondered through them
+		long					m_pondered_simulations = 0;		//not yet resolved by findRootNode
+		Average<float>			m_pondered_kept;
+		Average<float>			m_pondered_discarded;
+		int						m_prunes_in_move = 0;
+		Histogram<long>			m_tree_prunes_per_move;
+		Average<float>			m_pruned_nodes;			//nodes dropped by single pruning
+		std::shared_ptr<const OpeningBook>	m_opening_book;	//read-only, shared by main player and workers
+		long					m_book_lookups = 0;
+		long					m_book_hits = 0;
+		//batched evaluation : leaves wait for evaluation with virtual loss kept on their paths
+		struct PendingLeaf
+		{
+			GameState*	owned;		//rollout end state released after evaluation, nullptr for tree node's state
+			float		discount;
+			size_t		path_end;	//path of the leaf ends at this position of m_batch_paths
+		};
+		std::vector<PendingLeaf>		m_pending_leaves;
+		std::vector<const GameState*>	m_batch_states;
+		std::vector<int>				m_batch_scores;		//4 per leaf
+		Path_t							m_batch_paths;		//paths of pending leaves one after another
+		Average<float>					m_leaves_per_eval_call;
+		Average<float>					m_proven_node_ratio;
+		std::unique_ptr<SharedRootStats>	m_shared_stats;		//main player only, workers' statistics are merged before publishing
+		std::vector<SharedRootMove>		m_shared_moves;
+		Average<float>					m_shared_stats_merged;	//other processes merged by coordinator for single move
+#ifdef ENABLE_MCTS_PROFILE
+		SearchProfile					m_profile;			//this searcher since the last move
+		SearchProfileStats				m_profile_stats;	//main player only, all searchers' profiles are added every move
+		void profileMove(double move_seconds);
+#endif
 
-		Player(const MCTSConfig cfg, IMoveLimit *mv_limit, ITrace* trace);
-		~Player();
+		PlayerT(const MCTSConfig cfg, IMoveLimit *mv_limit, ITrace* trace);
+		~PlayerT();
 		void	seed(unsigned long seed) { m_generator.seed(seed); }
+		void	addWorker(PlayerT* worker);
+		void	setGameRulesFactory(CreateGameRules_t crf) { m_create_game_rules = crf; }
+		void	setOpeningBook(std::shared_ptr<const OpeningBook> book) { m_opening_book = book; }
 		void	release() override { delete this; }
 		void	startNewGame(GameState*) override;
 		void	endGame(int score, GameResult result) override;
@@ -158,30 +346,110 @@ namespace MC
 		void _dumpGameTree();
 		MoveList* selectMove(GameState* gs) override;
 		void runSingleSimulation();
+		int  runSimulations(GameState* pks);
 		std::tuple<Move*, float> runNSimulations(GameState* bs, int totNumSimulations);
-		string makeTreeFilename(const char* basename);
+		void forEachSearcher(std::function<void(PlayerT*)> op);
+		RootLead rootLead() const;
+		void startPondering(GameState* pks);
+		void stopPondering();
+		void beginPonderAccounting();
+		void endPonderAccounting();
+		void resolvePondered(const StateNode* new_root);
+		float averageBranchingFactor() const;
+		//single searcher with batched evaluation also runs tree parallel search, virtual loss keeps pending leaves apart
+		//information set search runs there too, so searchers share statistics of the nodes while sampling their own states
+		bool sharedTreeSearch() const { return m_cfg.TreeParallel || m_cfg.EvalBatchSize > 1 || m_cfg.InformationSetSearch; }
+		//shared tree nodes are linked from any number of parents, so they are always expanded
+		bool lazyExpansion() const { return m_cfg.LazyExpansion && !sharedTreeSearch(); }
+		int  runTreeParallelSimulations(float branching_factor);	//average of the tree owner, computed before searchers start
+		void runTreeParallelSimulation();
+		void addPendingLeaf(const Path_t& path, const GameState* state, GameState* owned, float discount);
+		void flushEvalBatch();
+		bool rollout(const GameState* start, int depth, int score[], float& discount, GameState** leaf = nullptr);
+		//rules calls timed by the search profile
+		GameState* applyMove(const GameState* s, Move* mv, int player)
+		{
+			PROFILE_PHASE(ApplyMove)
+			return m_game_rules->ApplyMove(s, mv, player);
+		}
+		void evaluate(const GameState* s, int score[])
+		{
+			PROFILE_PHASE(Evaluation)
+			m_eval_function(s, score);
+		}
+		StateNode* appendSharedNode(MoveNode* mn, GameState* pks, float p, PlayerT& searcher);
+		StateNode* addVirtualLoss(MoveNode* mn);
+		void removeVirtualLoss(MoveNode* mn);
+		void backpropagationShared(const Path_t& path, const int score[], float discount) { backpropagationShared(path.begin(), path.end(), score, discount); }
+		void backpropagationShared(typename Path_t::const_iterator first, typename Path_t::const_iterator last, const int score[], float discount);
+		std::mutex& statLock(const void* p) { return m_stat_locks[(reinterpret_cast<uintptr_t>(p) >> 5) % m_stat_locks.size()]; }
+		IGameRules* rulesOf(const StateNode* sn) const;
+		std::vector<MergedMoveStats> mergeRootStatistics(bool with_workers = true);
+		void publishRootStatistics(const std::vector<MergedMoveStats>& stats);
+		int  mergeSharedStatistics(std::vector<MergedMoveStats>& stats);
+		string makeTreeFilename(const char* basename, const char* extension = ".gv");
 		StateNode* findRootNode(GameState* s);
 		enum class VisitTreeOpResult { Cont=0, Abort, Skip  };
 		static void visitTree(StateNode* node, unsigned short id, std::function<bool(StateNode*)> visit);
-		static bool visitTreeDepthFirstInt(StateNode* node, unsigned short visit_id, std::function<Player::VisitTreeOpResult(StateNode*, int)> visit_op, int depth);
+		static bool visitTreeDepthFirstInt(StateNode* node, unsigned short visit_id, std::function<VisitTreeOpResult(StateNode*, int)> visit_op, int depth);
 		static void visitTreeDepthFirst(StateNode* node, unsigned short visit_id, std::function<VisitTreeOpResult(StateNode*, int)> visit_op);
 		bool checkTree(StateNode* root, unsigned short id, bool dump = true);
-		StateNode* find_breadth_first(StateNode*root, const GameState*s);
-		void freeSubTree(StateNode* root, unsigned short stay_alive_id, unsigned short visit_id);
-		Path_t selection_playOut(StateNode* root, unsigned short visit_id);
+		void reclaimUnreachableNodes();
+		std::unique_ptr<NodeArena_t> compactGeneration();
+		//pruning needs whole tree below the root, game tree dump keeps nodes above it too
+		bool overTreeBudget(double fraction = 1.0) const
+		{
+			return m_release_nodes_during_find &&
+				((m_cfg.MaxTreeBytes && m_nodeArena.get_current_usage() > fraction * m_cfg.MaxTreeBytes) ||
+				 (m_cfg.MaxNodes && m_nodeArena.get_live_count() > fraction * m_cfg.MaxNodes));
+		}
+		void pruneTree();
+		int collectPrunes();
+		StateNode* compactTree(StateNode* root, NodeArena_t& next_gen);
+		std::unique_ptr<NodeArena_t> takeSpareArena();
+		void releaseGeneration(std::unique_ptr<NodeArena_t> generation, bool background = true);
+		void releaseNodesInBlock(NodeArena_t& generation, size_t block_idx);
+		Path_t& selection_playOut(StateNode* root, RolloutResult& rollout_result);
+		ValidMoveList* validMoves(size_t path_idx) { return reinterpret_cast<ValidMoveList*>(m_valid_moves.data() + path_idx * ValidMoveListStride); }
+		//any change between two simulations means the simulation allocated memory
+		std::array<size_t, 4> bufferCapacities() const { return { m_path.capacity(), m_path_nodes.capacity(), m_to_be_freed.capacity(), m_nodeArena.get_reserved() }; }
+		void countAllocations(const std::array<size_t, 4>& before)
+		{
+			const auto after = bufferCapacities();
+			int allocations = 0;
+			for (size_t i = 0; i < after.size(); ++i) {
+				if (after[i] != before[i]) ++allocations;
+			}
+			m_allocations_per_simulation += Average<float>(float(allocations));
+		}
 		size_t selectOneOf(size_t first, size_t last);
-		void backpropagation(Path_t& path, bool cycle);
+		void markProven(StateNode* sn, const int score[]);
+		bool solveNode(StateNode* sn, const MoveNode* path_mn, const StateNode* path_next);
+		float provenNodeRatio();
+		//exact value of proven move instead of the estimate, so proven win is preferred over any estimate
+		static float provenOrWeight(const MoveNode& mv, int player, float weight) { return mv.next && mv.next->proven ? mv.next->provenValue(player) * mv.get_probability() : weight; }
+		void backpropagation(Path_t& path, bool cycle, const RolloutResult* rollout_result = nullptr);
 		void freeTemporaryNodes(StateNode * root, unsigned short visit_id);
 		void expansion(Path_t& path);
-		std::tuple<MoveNode*,size_t> selectMove(StateNode* node, const ValidMoveList& moves, double C, unsigned short visit_id);
+		//scores only the listed moves, returns the move and its position in the list
+		std::tuple<MoveNode*,size_t> selectMove(StateNode* node, const ValidMoveList& moves, double C);
 		MoveNode* selectBestMove(StateNode* node);
-		StateNode* makeTreeNode(GameState* pks);
+		MoveNode* selectBestMove(StateNode* node, const std::vector<MergedMoveStats>& stats);
+		size_t selectBestMoveIdx(const std::vector<float>& weights, const std::vector<unsigned>& visits);
+		StateNode* makeTreeNode(GameState* pks, bool expand = true);
+		StateNode* expandNode(StateNode* sn);
+		void pinMoveList(StateNode* sn);
+		void seedFromBook(StateNode* sn, IGameRules* gr);
+		void addToOpeningBook(OpeningBookWriter& book, int min_visits);
+		static uint64_t stateKey(IGameRules* gr, const GameState* pks) { return hashStateWords(gr->GetStateHash(pks), gr->GetStateHashSize()); }
+		StateNode* findTreeNode(IGameRules* gr, const GameState* pks);
 		void makeNodePermanent(StateNode * sn);
 		void freeTree(StateNode* node);
 		void freeTree(StateNode* root, std::vector<StateNode*>& toBeFreed, unsigned short visit_id);
 		void freeStateNode(StateNode* node);
 		StateNode* _alloc(int number_of_moves);
 		void _free(StateNode* node);
+		static size_t numSlots(int number_of_moves) { return (StateNode::bytes(number_of_moves) + NodeArena_t::SlotSize - 1) / NodeArena_t::SlotSize; }
 		void dumpTreeWithPath(const string& filename, StateNode* root, const Path_t& path);
 		void dumpTree(const string & filename, StateNode* root, std::set<StateNode*> nodesToHighlight = {});
 		void dumpNodeDescription(std::wofstream& out, StateNode* sn, bool highlight);
@@ -189,7 +457,15 @@ namespace MC
 		void dumpTreeNode(std::wofstream& out, StateNode* sn, unsigned visit_id, std::set<StateNode*>& nodesToHighlight);
 		std::tuple<StateNode*, Path_t> loadTreeFromFile(const char* filename);
 		std::tuple<StateNode*, Path_t> loadTree(std::wifstream& input);
+		//binary snapshot keeps exact statistics and loads without parsing, convertSnapshotToGraphviz makes it readable
+		void saveTreeSnapshot(const string& filename, StateNode* root, const Path_t& path = {});
+		std::tuple<StateNode*, Path_t> loadTreeSnapshot(const char* filename);
+		void convertSnapshotToGraphviz(const char* snapshot_filename, const string& gv_filename);
+		static void linkPath(Path_t& path);
 		void traceSelectMove(const wstring& state, const std::multimap<double, MoveNode*>& moves, const wstring& selected, StateNode* sn);
 	};
+	using Player = PlayerT<4, uint32_t>;
+	//explicit instantiations are in MCTSPlayer.cpp and MCTSPlayer_diagnostics.cpp
+#define MCTS_PLAYER_INSTANTIATIONS(X) X(2, uint16_t) X(2, uint32_t) X(4, uint16_t) X(4, uint32_t)
 	IGamePlayer* createMCTSPlayer(int player_number, const PlayerConfig_t& pc);
 }
@@ -6,6 +6,9 @@
 #include <codecvt>
 #include <iostream>
 #include <fstream>
+#include <unordered_map>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <GameRules.h>
 #include "MCTSPlayer.h"
 
@@ -16,7 +19,44 @@ using std::map;
 
 namespace MC
 {
-	void Player::dumpTreeWithPath(const string& filename, StateNode* root, const Path_t& path)
+	//tree snapshot : header, node table, move table, state hashes, path
+	//moves of node n follow moves of node n-1, states are rebuilt by IGameRules::CreateInitialStateFromHash
+#pragma pack (push,1)
+	struct SnapshotHeader
+	{
+		char		magic[4];
+		uint32_t	version;
+		uint32_t	num_players;	//of the player which wrote the file, moves always keep 4 values
+		uint32_t	hash_words;
+		uint32_t	num_nodes;
+		uint32_t	num_moves;
+		uint32_t	path_length;
+	};
+	struct SnapshotNode
+	{
+		uint32_t	num_visited;
+		uint8_t		num_moves;
+		uint8_t		current_player;
+		uint8_t		flags;			//SnapshotFlags
+		uint8_t		pad;
+	};
+	struct SnapshotMove
+	{
+		uint32_t	next;			//node index, NoNode if not expanded
+		uint32_t	num_visited;
+		float		value[4];
+		uint16_t	probability;
+		uint8_t		move_idx;
+		uint8_t		pad;
+	};
+#pragma pack(pop)
+	enum SnapshotFlags : uint8_t { SnapshotOccured = 1, SnapshotTemporary = 2, SnapshotTerminal = 4, SnapshotUnexpanded = 8 };
+	static const char SnapshotMagic[4] = { 'M','C','T','S' };
+	static const uint32_t SnapshotVersion = 1;
+	static const uint32_t NoNode = 0xffffffff;
+
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::dumpTreeWithPath(const string& filename, StateNode* root, const Path_t& path)
 	{
 		std::set<StateNode*> path_nodes;
 		for (auto[state_node, move_node] : path) {
@@ -25,7 +65,8 @@ namespace MC
 		dumpTree(filename, root, path_nodes);
 	}
 
-	void Player::dumpTree(const string & filename, StateNode* root, std::set<StateNode*> nodesToHighlight)
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::dumpTree(const string & filename, StateNode* root, std::set<StateNode*> nodesToHighlight)
 	{
 		//dot.exe -Tsvg mcts_tree_dump.gv -o mcts_tree_dump.svg -Goverlap=prism
 		std::wofstream out(filename);
@@ -36,7 +77,8 @@ namespace MC
 		out << L"}" << std::endl;
 	}
 
-	void Player::dumpNodeDescription(std::wofstream& out, StateNode* sn, bool highlight)
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::dumpNodeDescription(std::wofstream& out, StateNode* sn, bool highlight)
 	{
 		wstring name = m_game_rules->ToWString(sn->state);
 		boost::replace_all(name, L"|", L"\\n");
@@ -59,9 +101,11 @@ namespace MC
 		out << "]" << std::endl;
 	}
 
-	bool Player::dumpMoveDescription(std::wofstream& out, StateNode* sn, int dummyNodeId, const MoveNode& mv)
+	template <int NP, typename Counter>
+	bool PlayerT<NP, Counter>::dumpMoveDescription(std::wofstream& out, StateNode* sn, int dummyNodeId, const MoveNode& mv)
 	{
-		auto [mvmv,p] = m_game_rules->GetMoveFromList(sn->moveList, mv.moveIdx);
+		ScopedMoveList moves(m_game_rules, sn);
+		auto [mvmv,p] = moves.get(mv.moveIdx);
 		const wstring mv_name = m_game_rules->ToWString(mvmv);
 		bool needIncrement = false;
 		
@@ -70,7 +114,7 @@ namespace MC
 			const float prob = mv.get_probability();
 			assert(prob != 0);
 			if (mv.next->occupied) {
-				out << L"\"" << sn << L"\" -> \"" << mv.next << L"\" [label = <" << mv_name << L" nv = " << mv.numVisited;
+				out << L"\"" << sn << L"\" -> \"" << mv.next.load() << L"\" [label = <" << mv_name << L" nv = " << mv.numVisited;
 				out << L"<br/>val = ";
 				for (int i = 0; i < m_cfg.NumberOfPlayers; ++i) {
 					if (i > 0) out << L",";
@@ -85,9 +129,9 @@ namespace MC
 			}
 			else
 			{
-				out << L"\"" << sn << L"\" -> \"" << mv.next << L"\" [label = \"" << mv_name << L" corrupted\"";
+				out << L"\"" << sn << L"\" -> \"" << mv.next.load() << L"\" [label = \"" << mv_name << L" corrupted\"";
 				out << L" i=" << mv.moveIdx << L" p=" << std::setprecision(3) << prob << "\" color=red]" << std::endl;
-				out << L"\"" << mv.next << L"\" [label=\"corrupted\" color=red]" << std::endl;
+				out << L"\"" << mv.next.load() << L"\" [label=\"corrupted\" color=red]" << std::endl;
 				needIncrement = false;
 			}
 		}
@@ -100,7 +144,8 @@ namespace MC
 		return needIncrement;
 	}
 
-	void Player::dumpTreeNode(std::wofstream& out, StateNode* sn, unsigned visit_id, std::set<StateNode*>& nodesToHighlight)
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::dumpTreeNode(std::wofstream& out, StateNode* sn, unsigned visit_id, std::set<StateNode*>& nodesToHighlight)
 	{
 		if (visit_id == sn->lastVisitId) return;
 		if (sn->occupied != 1)
@@ -131,7 +176,8 @@ namespace MC
 		}
 	}
 
-	std::tuple<StateNode*, Path_t> Player::loadTreeFromFile(const char* filename)
+	template <int NP, typename Counter>
+	std::tuple<typename PlayerT<NP, Counter>::StateNode*, typename PlayerT<NP, Counter>::Path_t> PlayerT<NP, Counter>::loadTreeFromFile(const char* filename)
 	{
 		std::wifstream input(filename);
 		std::locale loc(std::locale::classic(), new std::codecvt_utf8<wchar_t>);
@@ -141,7 +187,8 @@ namespace MC
 
 	BOOST_XPRESSIVE_GLOBAL_MARK_TAG(s10, 10);
 	BOOST_XPRESSIVE_GLOBAL_MARK_TAG(s11, 11);
-	std::tuple<StateNode*, Path_t> Player::loadTree(std::wifstream& input)
+	template <int NP, typename Counter>
+	std::tuple<typename PlayerT<NP, Counter>::StateNode*, typename PlayerT<NP, Counter>::Path_t> PlayerT<NP, Counter>::loadTree(std::wifstream& input)
 	{
 		wstring line;
 		getline(input, line);
@@ -197,7 +244,8 @@ namespace MC
 				const float prob = std::stof(what[10]);
 
 				StateNode& sn = *sid2state[sid];
-				auto [move,p] = m_game_rules->GetMoveFromList(sn.moveList, mvIdx);
+				ScopedMoveList moves(m_game_rules, &sn);
+				auto [move,p] = moves.get(mvIdx);
 				auto name2 = m_game_rules->ToWString(move);
 				boost::erase_all(name2, " ");
 				assert(name == name2);
@@ -206,7 +254,9 @@ namespace MC
 					it = sid2move.insert( sid2move.begin(), {sid, {}} );
 				}
 				auto &mv = it->second;
-				MoveNode mn { reinterpret_cast<StateNode*>(target_sid), static_cast<uint8_t>(num_visited), static_cast<uint8_t>(mvIdx), 0, {val1,val2,val3,val4} };
+				const float values[4] = { val1,val2,val3,val4 };
+				MoveNode mn { reinterpret_cast<StateNode*>(target_sid), {}, static_cast<Counter>(num_visited), 0, static_cast<uint8_t>(mvIdx) };
+				std::copy(values, values + NP, mn.value);
 				mn.set_probability(prob);
 				mv.push_back( mn );
 			}
@@ -216,30 +266,154 @@ namespace MC
 		{
 			auto & moves = sid2move[sid];
 			for (auto & mv : moves)	{
-				mv.next = sid2state[reinterpret_cast<unsigned long long>(mv.next)];
+				mv.next = sid2state[reinterpret_cast<unsigned long long>(mv.next.load())];
 				sn->moves[mv.moveIdx] = mv;
 			}
 		}
 
 		//(3) initialize path edges
-		if (!path.empty()) {
-			for (int idx = 0; idx < path.size() - 1; ++idx)
+		linkPath(path);
+
+		return { root,path };
+	}
+
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::saveTreeSnapshot(const string& filename, StateNode* root, const Path_t& path)
+	{
+		vector<StateNode*> nodes;
+		std::unordered_map<const StateNode*, uint32_t> node_idx;
+		visitTree(root, ++m_curr_visit_id, [&](StateNode* sn) {
+			node_idx[sn] = uint32_t(nodes.size());
+			nodes.push_back(sn);
+			return true;
+		});
+		const size_t hash_words = m_game_rules->GetStateHashSize();
+		vector<SnapshotNode> node_table;
+		vector<SnapshotMove> move_table;
+		vector<uint32_t> hashes;
+		node_table.reserve(nodes.size());
+		hashes.reserve(nodes.size() * hash_words);
+		for (auto *sn : nodes)
+		{
+			const uint8_t flags = (sn->occured ? SnapshotOccured : 0) | (sn->temporary ? SnapshotTemporary : 0) | (sn->terminal ? SnapshotTerminal : 0) | (sn->unexpanded ? SnapshotUnexpanded : 0);
+			node_table.push_back({ uint32_t(sn->numVisited), sn->numMoves, sn->currentPlayer, flags, 0 });
+			for (int mi = 0; mi < sn->numMoves; ++mi)
 			{
-				auto *n = path[idx].first;
-				auto *next = path[idx + 1].first;
-				for (int mi = 0; mi < n->numMoves; ++mi) {
-					if (n->moves[mi].next == next) {
-						path[idx].second = n->moves + mi;
-						break;
-					}
-				}
+				const auto & mv = sn->moves[mi];
+				SnapshotMove sm{ mv.next ? node_idx[mv.next] : NoNode, uint32_t(mv.numVisited), {0,0,0,0}, mv.probability, mv.moveIdx, 0 };
+				std::copy(mv.value, mv.value + NP, sm.value);
+				move_table.push_back(sm);
 			}
+			const uint32_t *hash = rulesOf(sn)->GetStateHash(sn->state);
+			hashes.insert(hashes.end(), hash, hash + hash_words);
 		}
+		vector<uint32_t> path_nodes;
+		for (auto & step : path) {
+			path_nodes.push_back(node_idx[step.first]);
+		}
+		SnapshotHeader header{ {}, SnapshotVersion, uint32_t(NP), uint32_t(hash_words), uint32_t(node_table.size()), uint32_t(move_table.size()), uint32_t(path_nodes.size()) };
+		std::copy(SnapshotMagic, SnapshotMagic + 4, header.magic);
 
-		return { root,path };
+		std::ofstream out(filename, std::ios::binary);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(node_table.data()), node_table.size() * sizeof(SnapshotNode));
+		out.write(reinterpret_cast<const char*>(move_table.data()), move_table.size() * sizeof(SnapshotMove));
+		out.write(reinterpret_cast<const char*>(hashes.data()), hashes.size() * sizeof(uint32_t));
+		out.write(reinterpret_cast<const char*>(path_nodes.data()), path_nodes.size() * sizeof(uint32_t));
 	}
 
-	void Player::traceSelectMove(const wstring& state, const std::multimap<double, MoveNode*>& moves, const wstring& selected, StateNode* sn)
+	template <int NP, typename Counter>
+	std::tuple<typename PlayerT<NP, Counter>::StateNode*, typename PlayerT<NP, Counter>::Path_t> PlayerT<NP, Counter>::loadTreeSnapshot(const char* filename)
+	{
+		using namespace boost::interprocess;
+		file_mapping file(filename, read_only);
+		mapped_region region(file, read_only);
+		const auto *begin = static_cast<const uint8_t*>(region.get_address());
+		const size_t size = region.get_size();
+
+		if (size < sizeof(SnapshotHeader)) throw "invalid_file_format";
+		const auto & header = *reinterpret_cast<const SnapshotHeader*>(begin);
+		if (!std::equal(SnapshotMagic, SnapshotMagic + 4, header.magic) || header.version != SnapshotVersion) throw "invalid_file_format";
+		if (header.hash_words != m_game_rules->GetStateHashSize()) throw "invalid_file_format";
+		const size_t expected_size = sizeof(SnapshotHeader) + header.num_nodes * sizeof(SnapshotNode) + header.num_moves * sizeof(SnapshotMove)
+			+ (size_t(header.num_nodes) * header.hash_words + header.path_length) * sizeof(uint32_t);
+		if (size != expected_size) throw "invalid_file_format";
+		const auto *node_table = reinterpret_cast<const SnapshotNode*>(begin + sizeof(SnapshotHeader));
+		const auto *move_table = reinterpret_cast<const SnapshotMove*>(node_table + header.num_nodes);
+		const auto *hashes = reinterpret_cast<const uint32_t*>(move_table + header.num_moves);
+		const auto *path_nodes = hashes + size_t(header.num_nodes) * header.hash_words;
+
+		//(1) rebuild states, nodes are indexed in the order of the node table
+		//unexpanded node is saved without moves and loaded expanded
+		vector<StateNode*> nodes(header.num_nodes);
+		for (uint32_t ni = 0; ni < header.num_nodes; ++ni)
+		{
+			const auto & rec = node_table[ni];
+			auto *s = m_game_rules->CreateInitialStateFromHash(hashes + size_t(ni) * header.hash_words);
+			StateNode *sn = makeTreeNode(s);
+			if (sn->state != s) m_game_rules->ReleaseGameState(s);
+			const bool moves_match = sn->numMoves == rec.num_moves || (rec.flags & SnapshotUnexpanded && 0 == rec.num_moves);
+			if (!moves_match || sn->currentPlayer != rec.current_player) throw "invalid_file_format";
+			sn->numVisited = rec.num_visited;
+			sn->occured = rec.flags & SnapshotOccured ? 1 : 0;
+			sn->temporary = rec.flags & SnapshotTemporary ? 1 : 0;
+			sn->terminal = rec.flags & SnapshotTerminal ? 1 : 0;
+			nodes[ni] = sn;
+		}
+		//(2) moves of every node are stored in order, so the move table is read sequentially
+		const SnapshotMove *sm = move_table;
+		for (uint32_t ni = 0; ni < header.num_nodes; ++ni)
+		{
+			StateNode *sn = nodes[ni];
+			for (int mi = 0; mi < node_table[ni].num_moves; ++mi, ++sm)
+			{
+				if (sm->move_idx >= sn->numMoves || (sm->next != NoNode && sm->next >= header.num_nodes)) throw "invalid_file_format";
+				auto & mv = sn->moves[sm->move_idx];
+				mv.next = sm->next != NoNode ? nodes[sm->next] : nullptr;
+				std::copy(sm->value, sm->value + NP, mv.value);
+				mv.numVisited = static_cast<Counter>(sm->num_visited);
+				mv.probability = sm->probability;
+				mv.moveIdx = sm->move_idx;
+			}
+		}
+		//(3) initialize path edges
+		Path_t path;
+		for (uint32_t pi = 0; pi < header.path_length; ++pi) {
+			path.push_back({ nodes.at(path_nodes[pi]), nullptr });
+		}
+		linkPath(path);
+		return { nodes.empty() ? nullptr : nodes.front(), path };
+	}
+
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::convertSnapshotToGraphviz(const char* snapshot_filename, const string& gv_filename)
+	{
+		//snapshot is loaded into the player's tree and released after dump, so the player should not hold any other tree
+		auto [root, path] = loadTreeSnapshot(snapshot_filename);
+		if (!root) return;
+		dumpTreeWithPath(gv_filename, root, path);
+		freeTree(root);
+	}
+
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::linkPath(Path_t& path)
+	{
+		if (path.empty()) return;
+		for (size_t idx = 0; idx < path.size() - 1; ++idx)
+		{
+			auto *n = path[idx].first;
+			auto *next = path[idx + 1].first;
+			for (int mi = 0; mi < n->numMoves; ++mi) {
+				if (n->moves[mi].next == next) {
+					path[idx].second = n->moves + mi;
+					break;
+				}
+			}
+		}
+	}
+
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::traceSelectMove(const wstring& state, const std::multimap<double, MoveNode*>& moves, const wstring& selected, StateNode* sn)
 	{
 		/*
 		std::wstringstream ss;
@@ -253,21 +427,24 @@ namespace MC
 		TRACE(m_trace,ss.str().c_str());
 		*/
 	}
-	void Player::_dumpMoveTree()
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::_dumpMoveTree()
 	{
 		if (!m_cfg.traceMoveFilename.empty()) {
-			dumpTree(makeTreeFilename(m_cfg.traceMoveFilename.c_str()), m_root);
+			saveTreeSnapshot(makeTreeFilename(m_cfg.traceMoveFilename.c_str(), ".mcts"), m_root);
 		}
 	}
 
-	void Player::_dumpGameTree()
+	template <int NP, typename Counter>
+	void PlayerT<NP, Counter>::_dumpGameTree()
 	{
 		if (!m_cfg.gameTreeFilename.empty()) {
-			dumpTree(makeTreeFilename(m_cfg.gameTreeFilename.c_str()), m_super_root);
+			saveTreeSnapshot(makeTreeFilename(m_cfg.gameTreeFilename.c_str(), ".mcts"), m_super_root);
 		}
 	}
 
-	bool Player::checkTree(StateNode* root, unsigned short id, bool dump)
+	template <int NP, typename Counter>
+	bool PlayerT<NP, Counter>::checkTree(StateNode* root, unsigned short id, bool dump)
 	{
 		bool error = false;
 		visitTree(root, id, [&](StateNode* sn) {
@@ -285,4 +462,24 @@ namespace MC
 		assert(!error);
 		return error;
 	}
-}
\ No newline at end of file
+
+	//class itself is instantiated in MCTSPlayer.cpp, members defined here are instantiated one by one
+#define INSTANTIATE_MCTS_DIAGNOSTICS(np, counter) \
+	template void PlayerT<np, counter>::dumpTreeWithPath(const string&, StateNode*, const Path_t&); \
+	template void PlayerT<np, counter>::dumpTree(const string&, StateNode*, std::set<StateNode*>); \
+	template void PlayerT<np, counter>::dumpNodeDescription(std::wofstream&, StateNode*, bool); \
+	template bool PlayerT<np, counter>::dumpMoveDescription(std::wofstream&, StateNode*, int, const MoveNode&); \
+	template void PlayerT<np, counter>::dumpTreeNode(std::wofstream&, StateNode*, unsigned, std::set<StateNode*>&); \
+	template std::tuple<PlayerT<np, counter>::StateNode*, PlayerT<np, counter>::Path_t> PlayerT<np, counter>::loadTreeFromFile(const char*); \
+	template std::tuple<PlayerT<np, counter>::StateNode*, PlayerT<np, counter>::Path_t> PlayerT<np, counter>::loadTree(std::wifstream&); \
+	template void PlayerT<np, counter>::saveTreeSnapshot(const string&, StateNode*, const Path_t&); \
+	template std::tuple<PlayerT<np, counter>::StateNode*, PlayerT<np, counter>::Path_t> PlayerT<np, counter>::loadTreeSnapshot(const char*); \
+	template void PlayerT<np, counter>::convertSnapshotToGraphviz(const char*, const string&); \
+	template void PlayerT<np, counter>::linkPath(Path_t&); \
+	template void PlayerT<np, counter>::traceSelectMove(const wstring&, const std::multimap<double, MoveNode*>&, const wstring&, StateNode*); \
+	template void PlayerT<np, counter>::_dumpMoveTree(); \
+	template void PlayerT<np, counter>::_dumpGameTree(); \
+	template bool PlayerT<np, counter>::checkTree(StateNode*, unsigned short, bool);
+	MCTS_PLAYER_INSTANTIATIONS(INSTANTIATE_MCTS_DIAGNOSTICS)
+#undef INSTANTIATE_MCTS_DIAGNOSTICS
+}
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "MCTSPlayer.h"
+#include "time_manager.h"
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS  
+#include <boost/dll/import.hpp> // for import_alias
 #include <Trace.h>
 
 using namespace Trace;
@@ -20,20 +22,6 @@ namespace MC
 		void release() override { delete this; }
 	};
 
-	struct TimeMoveLimit : IMoveLimit
-	{
-		const unsigned TimeLimitmiliSec;
-		std::chrono::time_point<CLK> tp_start;
-		TimeMoveLimit(double timeLimit) : TimeLimitmiliSec(unsigned(timeLimit * 1000)) {}
-		void start() override { tp_start = CLK::now(); }
-		bool can_continue() override
-		{
-			const auto mseconds = std::chrono::duration_cast<std::chrono::milliseconds>(CLK::now() - tp_start).count();
-			return mseconds < TimeLimitmiliSec;
-		}
-		void release() override { delete this; }
-	};
-
 	IMoveLimit* createMoveLimit(const PlayerConfig_t& pc)
 	{
 		const auto move_time_limit = pc.get_optional<float>("move_time_limit");
@@ -41,7 +29,45 @@ namespace MC
 		if (move_sim_limit) {
 			return new NumSimMoveLimit(move_sim_limit.get());
 		}
-		return new TimeMoveLimit(move_time_limit.get_value_or(1.0));
+		TimeManagerConfig cfg;
+		cfg.MoveTimeLimit = move_time_limit.get_value_or(1.0);
+		cfg.GameTimeLimit = pc.get_optional<float>("game_time_limit").get_value_or(0);
+		cfg.ExpectedGameMoves = pc.get_optional<int>("expected_game_moves").get_value_or(40);
+		cfg.EarlyStop = pc.get_optional<int>("early_stop").get_value_or(1) == 1;
+		return new TimeManager<>(cfg);
+	}
+	template <int NP, typename Counter>
+	IGamePlayer* createSearch(const MCTSConfig& cfg, const PlayerConfig_t& pc)
+	{
+		auto logger = createInstance(pc.get_optional<string>("trace").get_value_or(""), cfg.outDir);
+		auto move_limit = createMoveLimit(pc);
+		auto player = new PlayerT<NP, Counter>(cfg, move_limit, logger);
+		if (cfg.SearchThreads > 1 || cfg.BackgroundReclaim || cfg.Ponder)
+		{
+			//workers, background reclamation and pondering need private rules instances
+			CreateGameRules_t createGameRules = boost::dll::import_alias<IGameRules*(int number_of_players)>(
+				pc.get<string>("rules_provider"),
+				"createGameRules",
+				boost::dll::load_mode::append_decorations);
+			player->setGameRulesFactory(createGameRules);
+		}
+		if (cfg.SearchThreads > 1)
+		{
+			for (int wi = 1; wi < cfg.SearchThreads; ++wi)
+			{
+				MCTSConfig wcfg = cfg;
+				wcfg.seed = cfg.seed + wi;		//every worker needs its own random stream
+				wcfg.SearchThreads = 1;
+				wcfg.BackgroundReclaim = false;	//workers use main player's queue
+				wcfg.Ponder = false;			//main player runs workers while pondering
+				wcfg.OpeningBookFilename.clear();	//workers share main player's book
+				wcfg.SharedStatsFilename.clear();	//main player publishes merged statistics of all workers
+				wcfg.traceMoveFilename.clear();
+				wcfg.gameTreeFilename.clear();
+				player->addWorker(new PlayerT<NP, Counter>(wcfg, createMoveLimit(pc), createInstance("")));
+			}
+		}
+		return player;
 	}
 	IGamePlayer* createMCTSPlayer(int player_number, const PlayerConfig_t& pc)
 	{
@@ -62,10 +88,33 @@ namespace MC
 		cfg.BestMoveValueEps = pc.get_optional<float>("best_move_value_eps").get_value_or(0.005f);
 		cfg.CycleScore = pc.get_optional<int>("cycle_score").get_value_or(50);
 		cfg.Name = pc.get_optional<string>("fullname").get_value_or(pc.get<string>("name"));
+		cfg.SearchThreads = pc.get_optional<int>("search_threads").get_value_or(1);
+		cfg.TreeParallel = pc.get_optional<int>("tree_parallel").get_value_or(0) == 1;
+		cfg.VirtualLoss = pc.get_optional<int>("virtual_loss").get_value_or(1);
+		cfg.BackgroundReclaim = pc.get_optional<int>("background_reclaim").get_value_or(0) == 1;
+		cfg.LightRollout = pc.get_optional<int>("light_rollout").get_value_or(0) == 1;
+		cfg.Ponder = pc.get_optional<int>("ponder").get_value_or(0) == 1;
+		cfg.PonderMaxSimulations = pc.get_optional<int>("ponder_max_simulations").get_value_or(100000);
+		cfg.MaxTreeBytes = pc.get_optional<size_t>("max_tree_bytes").get_value_or(0);
+		cfg.MaxNodes = pc.get_optional<size_t>("max_nodes").get_value_or(0);
+		cfg.OpeningBookFilename = pc.get_optional<string>("opening_book").get_value_or("");
+		cfg.OpeningBookMaxVisits = pc.get_optional<int>("opening_book_max_visits").get_value_or(100);
+		cfg.EvalBatchSize = pc.get_optional<int>("eval_batch_size").get_value_or(1);
+		cfg.Solver = pc.get_optional<int>("solver").get_value_or(0) == 1;
+		cfg.LazyExpansion = pc.get_optional<int>("lazy_expansion").get_value_or(0) == 1;
+		cfg.InformationSetSearch = pc.get_optional<int>("information_set_search").get_value_or(0) == 1;
+		cfg.SharedStatsFilename = pc.get_optional<string>("shared_stats_file").get_value_or("");
+		cfg.SharedStatsSlot = pc.get_optional<int>("shared_stats_slot").get_value_or(0);
+		cfg.SharedStatsProcesses = pc.get_optional<int>("shared_stats_processes").get_value_or(1);
+		cfg.SharedStatsInterval = __max(1, pc.get_optional<int>("shared_stats_interval").get_value_or(1000));
 		
-		auto logger = createInstance(pc.get_optional<string>("trace").get_value_or(""), cfg.outDir);
-		auto move_limit = createMoveLimit(pc);
-		return new Player(cfg, move_limit, logger);
+		const int counter_bits = pc.get_optional<int>("visit_counter_bits").get_value_or(32);	//16 is enough while no move gets over 65535 visits
+
+		//node layout is fixed at compile time, 2 player games keep only 2 values per move
+		if (2 == cfg.NumberOfPlayers) {
+			return counter_bits == 16 ? createSearch<2, uint16_t>(cfg, pc) : createSearch<2, uint32_t>(cfg, pc);
+		}
+		return counter_bits == 16 ? createSearch<4, uint16_t>(cfg, pc) : createSearch<4, uint32_t>(cfg, pc);
 	}
 	IGamePlayer* createMCPlayer(int player_number, const PlayerConfig_t& pc)
 	{
@@ -0,0 +1,143 @@
+#pragma once
+#include <chrono>
+#include <array>
+#include "Metrics.h"
+
+//time spent by the search in its phases, compiled in only with ENABLE_MCTS_PROFILE defined in project settings
+//the define changes PlayerT layout, so all translation units including MCTSPlayer.h have to see the same value
+//clock is read only during every SampleInterval-th simulation, sampled times are scaled to all simulations of the move
+//phases nest (selection contains node creation and ApplyMove), every phase reports its inclusive time
+namespace MC
+{
+	enum class SearchPhase { Selection = 0, Playout, NodeCreation, ApplyMove, Evaluation, Backpropagation, Expansion, Reclamation, Count };
+
+	struct SearchProfile
+	{
+		static const int SampleInterval = 16;
+		static const int NumPhases = int(SearchPhase::Count);
+		using Clock = std::chrono::steady_clock;
+		using Seconds = std::chrono::duration<double>;
+
+		//current move
+		std::array<Clock::duration, NumPhases>	phase_time{};
+		long	simulations = 0;
+		long	sampled_simulations = 0;
+		long	nodes_allocated = 0;
+		long	nodes_freed = 0;
+		bool	sampling = false;
+
+		void startSimulation()
+		{
+			sampling = 0 == simulations++ % SampleInterval;
+			if (sampling) ++sampled_simulations;
+		}
+		//estimated seconds of the phase during the whole move
+		double phaseSeconds(SearchPhase phase) const
+		{
+			const double scale = sampled_simulations > 0 ? double(simulations) / sampled_simulations : 1.0;
+			//reclamation runs outside simulations and is always timed
+			return std::chrono::duration_cast<Seconds>(phase_time[int(phase)]).count() * (phase == SearchPhase::Reclamation ? 1.0 : scale);
+		}
+		//pondered simulations do not count to the move, reclamation and node counts since the last move do
+		void startMove()
+		{
+			for (int pi = 0; pi < NumPhases; ++pi) {
+				if (pi != int(SearchPhase::Reclamation)) phase_time[pi] = Clock::duration::zero();
+			}
+			simulations = sampled_simulations = 0;
+			sampling = false;
+		}
+		void reset()
+		{
+			phase_time.fill(Clock::duration::zero());
+			simulations = sampled_simulations = nodes_allocated = nodes_freed = 0;
+			sampling = false;
+		}
+		SearchProfile& operator+=(const SearchProfile& other)
+		{
+			for (int pi = 0; pi < NumPhases; ++pi) phase_time[pi] += other.phase_time[pi];
+			simulations += other.simulations;
+			sampled_simulations += other.sampled_simulations;
+			nodes_allocated += other.nodes_allocated;
+			nodes_freed += other.nodes_freed;
+			return *this;
+		}
+	};
+
+	//per move results of all searchers of the player
+	struct SearchProfileStats
+	{
+		std::array<Histogram<float>, SearchProfile::NumPhases>	phase_share;	//part of searchers' move time
+		Average<float>		reclamation_ms;
+		Histogram<long>		nodes_allocated;
+		Histogram<long>		nodes_freed;
+		Histogram<long>		pool_bytes;
+
+		SearchProfileStats()
+		{
+			for (auto & h : phase_share) h.Rounding(2);
+			nodes_allocated.Rounding(2);
+			nodes_freed.Rounding(2);
+			pool_bytes.Rounding(4).Prefix('K');
+		}
+		//searcher_seconds : move time multiplied by number of searchers
+		void addMove(const SearchProfile& profile, double searcher_seconds, size_t pool_bytes_in_use)
+		{
+			for (int pi = 0; pi < SearchProfile::NumPhases; ++pi)
+			{
+				if (pi == int(SearchPhase::Reclamation)) continue;
+				phase_share[pi].insert(searcher_seconds > 0 ? float(profile.phaseSeconds(SearchPhase(pi)) / searcher_seconds) : 0.0f);
+			}
+			reclamation_ms += Average<float>(float(1000 * profile.phaseSeconds(SearchPhase::Reclamation)));
+			nodes_allocated.insert(profile.nodes_allocated);
+			nodes_freed.insert(profile.nodes_freed);
+			pool_bytes.insert(long(pool_bytes_in_use));
+		}
+		void getStats(NamedMetrics_t& nm) const
+		{
+			static const char* names[SearchProfile::NumPhases] = { "selection", "playout", "node_creation", "apply_move", "evaluation", "backpropagation", "expansion", "reclamation" };
+			for (int pi = 0; pi < SearchProfile::NumPhases; ++pi) {
+				if (pi != int(SearchPhase::Reclamation)) nm[std::string("profile_") + names[pi] + "_share"] = phase_share[pi];
+			}
+			nm["profile_reclamation_ms"] = reclamation_ms;
+			nm["profile_nodes_allocated"] = nodes_allocated;
+			nm["profile_nodes_freed"] = nodes_freed;
+			nm["profile_pool_bytes"] = pool_bytes;
+		}
+	};
+
+	struct SearchProfileScope
+	{
+		SearchProfileScope(SearchProfile& profile, SearchPhase phase, bool always = false) :
+			profile(profile.sampling || always ? &profile : nullptr), phase(phase)
+		{
+			if (this->profile) t0 = SearchProfile::Clock::now();
+		}
+		~SearchProfileScope()
+		{
+			if (profile) profile->phase_time[int(phase)] += SearchProfile::Clock::now() - t0;
+		}
+		SearchProfileScope(const SearchProfileScope&) = delete;
+		SearchProfileScope& operator=(const SearchProfileScope&) = delete;
+
+		SearchProfile*	profile;
+		SearchPhase		phase;
+		SearchProfile::Clock::time_point t0;
+	};
+}
+
+#ifdef ENABLE_MCTS_PROFILE
+  #define PROFILE_CONCAT_(a, b) a##b
+  #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+  #define PROFILE_PHASE_OF(profile, phase) MC::SearchProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(profile, MC::SearchPhase::phase);
+  #define PROFILE_PHASE(phase) PROFILE_PHASE_OF(m_profile, phase)
+  #define PROFILE_PHASE_ALWAYS(phase) MC::SearchProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(m_profile, MC::SearchPhase::phase, true);
+  #define PROFILE_SIMULATION() m_profile.startSimulation();
+  #define PROFILE_ADD(counter, n) m_profile.counter += long(n);
+#else
+  #define PROFILE_PHASE_OF(profile, phase)
+  #define PROFILE_PHASE(phase)
+  #define PROFILE_PHASE_ALWAYS(phase)
+  #define PROFILE_SIMULATION()
+  #define PROFILE_ADD(counter, n)
+#endif
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "ucb_kernel.h"
+
+namespace MC
+{
+	//alternative node layout with hot/cold split, tree policy touches only the header and the hot arrays
+	//one allocation holds : header | hot : valueCp[n] probability[n] visits[n] | cold : next[n] valueOther[n][3]
+	//hot arrays are padded to multiple of 4 entries, so the kernel can load full vectors
+	struct SoANode
+	{
+		GameState*		state;			//8
+		MoveList*		moveList;		//8
+		int				numVisited;		//4
+		unsigned char	currentPlayer;	//1
+		unsigned char	numMoves;		//1
+		unsigned short	coldOffset;		//2 bytes from the header to the cold region
+		unsigned char	pad[8];			//8
+
+		static int paddedMoves(int num_moves)	{ return (num_moves + 3) & ~3; }
+		static size_t hotBytes(int num_moves)	{ return paddedMoves(num_moves) * (sizeof(float) + 2 * sizeof(uint16_t)); }
+		static size_t coldBytes(int num_moves)	{ return num_moves * (sizeof(SoANode*) + 3 * sizeof(float)); }
+		static size_t size(int num_moves)
+		{
+			//cold region starts 8 byte aligned
+			return sizeof(SoANode) + ((hotBytes(num_moves) + 7) & ~size_t(7)) + coldBytes(num_moves);
+		}
+
+		float*		valueCp()		{ return reinterpret_cast<float*>(this + 1); }
+		uint16_t*	probability()	{ return reinterpret_cast<uint16_t*>(valueCp() + paddedMoves(numMoves)); }
+		uint16_t*	visits()		{ return probability() + paddedMoves(numMoves); }
+		SoANode**	next()			{ return reinterpret_cast<SoANode**>(reinterpret_cast<uint8_t*>(this) + coldOffset); }
+		float		(*valueOther())[3]	{ return reinterpret_cast<float(*)[3]>(next() + numMoves); }
+		const float*	valueCp() const			{ return const_cast<SoANode*>(this)->valueCp(); }
+		const uint16_t*	probability() const		{ return const_cast<SoANode*>(this)->probability(); }
+		const uint16_t*	visits() const			{ return const_cast<SoANode*>(this)->visits(); }
+
+		float value(int move_idx, int player)
+		{
+			if (player == currentPlayer) return valueCp()[move_idx];
+			return valueOther()[move_idx][player < currentPlayer ? player : player - 1];
+		}
+		void addVisit(int move_idx, const float value[4])
+		{
+			if (visits()[move_idx] < UINT16_MAX) ++visits()[move_idx];
+			for (int p = 0, other = 0; p < 4; ++p) {
+				if (p == currentPlayer) valueCp()[move_idx] += value[p];
+				else valueOther()[move_idx][other++] += value[p];
+			}
+		}
+
+		//copies statistics of AoS node, children pointers are not translated
+		//visit counters saturate at 16 bit, values of players missing in the source node stay zero
+		template <typename StateNode, typename Alloc>
+		static SoANode* create(const StateNode& sn, Alloc alloc)
+		{
+			const int np = StateNode::MoveNode::NumPlayers;
+			const int n = sn.numMoves;
+			auto *node = reinterpret_cast<SoANode*>(alloc(size(n)));
+			memset(node, 0, size(n));
+			node->state = sn.state;
+			node->moveList = sn.moveList;
+			node->numVisited = sn.numVisited;
+			node->currentPlayer = sn.currentPlayer;
+			node->numMoves = sn.numMoves;
+			node->coldOffset = static_cast<unsigned short>(sizeof(SoANode) + ((hotBytes(n) + 7) & ~size_t(7)));
+			for (int mi = 0; mi < n; ++mi)
+			{
+				const auto & mv = sn.moves[mi];
+				node->probability()[mi] = mv.probability;
+				node->visits()[mi] = static_cast<uint16_t>(__min(mv.numVisited, UINT16_MAX));
+				for (int p = 0, other = 0; p < np; ++p) {
+					if (p == sn.currentPlayer) node->valueCp()[mi] = mv.value[p];
+					else node->valueOther()[mi][other++] = mv.value[p];
+				}
+			}
+			return node;
+		}
+	};
+	static_assert(sizeof(SoANode) == 32, "SoANode header must keep hot arrays 16 byte aligned");
+
+	namespace UCB
+	{
+		//same score as for MoveNode array, out must have room for paddedMoves(numMoves) entries
+		inline void scores(const SoANode& node, float c_sqrt_log, float* out)
+		{
+			const float* value = node.valueCp();
+			const uint16_t* prob = node.probability();
+			const uint16_t* visits = node.visits();
+			int mi = 0;
+#if defined(UCB_KERNEL_AVX2) || defined(UCB_KERNEL_SSE2)
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 prob_scale = _mm_set1_ps(UCB::ProbScale);
+			const __m128 c = _mm_set1_ps(c_sqrt_log);
+			for (; mi < node.numMoves; mi += 4)
+			{
+				const __m128i v32 = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(visits + mi)), zero);
+				const __m128i p32 = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(prob + mi)), zero);
+				const __m128 oo_visited = _mm_div_ps(one, _mm_add_ps(one, _mm_cvtepi32_ps(v32)));
+				const __m128 weight = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(value + mi), _mm_mul_ps(_mm_cvtepi32_ps(p32), prob_scale)), oo_visited);
+				_mm_storeu_ps(out + mi, _mm_add_ps(weight, _mm_mul_ps(c, _mm_sqrt_ps(oo_visited))));
+			}
+#else
+			for (; mi < node.numMoves; ++mi) {
+				const float oo_visited = 1.0f / (1.0f + visits[mi]);
+				out[mi] = value[mi] * (prob[mi] * UCB::ProbScale) * oo_visited + c_sqrt_log * std::sqrt(oo_visited);
+			}
+#endif
+		}
+	}
+}
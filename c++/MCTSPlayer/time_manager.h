@@ -0,0 +1,120 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include "MCTSPlayer.h"
+
+namespace MC
+{
+	struct TimeManagerConfig
+	{
+		double	MoveTimeLimit = 1.0;		//seconds, never exceeded by single move
+		double	GameTimeLimit = 0;			//seconds for all own moves in the game, 0 : every move gets MoveTimeLimit
+		int		ExpectedGameMoves = 40;		//own moves in a game, replaced by the average once a game is finished
+		double	CheckPeriod = 0.001;		//seconds between clock reads
+		bool	EarlyStop = true;			//stop when the selected move can not lose its visit lead in the remaining time
+	};
+
+	//time limit of the move reading the clock every check_interval simulations
+	//check_interval follows the measured simulation rate, so the clock is read about once per CheckPeriod
+	//with game budget the time left is split evenly between expected remaining moves,
+	//moves with more root moves than the game average get proportionally more, up to twice the share
+	//Clock is a template parameter, so tests can drive the time
+	template <typename Clock = CLK>
+	struct TimeManager : IMoveLimit
+	{
+		static const int MaxCheckInterval = 4096;
+		static const int MinMovesLeft = 4;	//part of the game budget kept for moves beyond expected game length
+
+		TimeManager(const TimeManagerConfig& cfg) : m_cfg(cfg), m_budget(cfg.MoveTimeLimit) {}
+
+		void start() override
+		{
+			m_tp_start = Clock::now();
+			m_simulations = 0;
+			m_check_interval = 1;
+			m_next_check = 1;
+			m_last_check = { 0, 0 };
+			m_start_visits = m_root_lead ? m_root_lead().root_visits : 0;
+		}
+		void startMove(int root_moves, float average_branching_factor) override
+		{
+			m_budget = m_cfg.MoveTimeLimit;
+			if (m_cfg.GameTimeLimit > 0)
+			{
+				const int expected_moves = m_game_moves.m_count > 0 ? int(m_game_moves.m_value / m_game_moves.m_count) : m_cfg.ExpectedGameMoves;
+				const int moves_left = std::max(expected_moves - m_moves_in_game, MinMovesLeft);
+				const double weight = average_branching_factor > 0 ? std::min(std::max(root_moves / average_branching_factor, 0.5f), 2.0f) : 1.0;
+				m_budget = std::min(m_budget, std::max(0.0, m_cfg.GameTimeLimit - m_game_time_used) / moves_left * weight);
+			}
+			start();
+		}
+		bool can_continue() override
+		{
+			if (++m_simulations < m_next_check) return true;
+
+			const double elapsed = std::chrono::duration<double>(Clock::now() - m_tp_start).count();
+			const double since_last_check = elapsed - m_last_check.elapsed;
+			if (since_last_check > 0) {
+				const double rate = (m_simulations - m_last_check.simulations) / since_last_check;
+				m_check_interval = std::min(std::max(int(rate * m_cfg.CheckPeriod), 1), int(MaxCheckInterval));
+			}
+			m_last_check = { m_simulations, elapsed };
+			m_next_check = m_simulations + m_check_interval;
+
+			if (elapsed >= m_budget) return stop(elapsed, false);
+			if (m_cfg.EarlyStop && m_root_lead && elapsed > 0)
+			{
+				//root visits include other searchers' simulations in tree parallel mode
+				const RootLead rl = m_root_lead();
+				const double visits_left = (rl.root_visits - m_start_visits) / elapsed * (m_budget - elapsed);
+				if (rl.lead > visits_left) return stop(elapsed, true);
+			}
+			return true;
+		}
+		void release() override { delete this; }
+		void startGame() override
+		{
+			m_moves_in_game = 0;
+			m_game_time_used = 0;
+		}
+		void endGame() override
+		{
+			if (m_moves_in_game > 0) {
+				m_game_moves += Average<float>(float(m_moves_in_game));
+			}
+		}
+		void setRootLead(std::function<RootLead()> root_lead) override { m_root_lead = root_lead; }
+		void getStats(NamedMetrics_t& nm) const override
+		{
+			nm["time_saved_per_move"] = m_saved_time;
+			nm["early_stop_ratio"] = m_early_stop;
+		}
+		double budget() const { return m_budget; }
+
+	protected:
+		bool stop(double elapsed, bool early)
+		{
+			++m_moves_in_game;
+			m_game_time_used += elapsed;
+			m_saved_time += Average<float>(float(std::max(0.0, m_budget - elapsed)));
+			m_early_stop += Average<float>(early ? 1.0f : 0.0f);
+			return false;
+		}
+
+		const TimeManagerConfig	m_cfg;
+		std::function<RootLead()>	m_root_lead;
+		typename Clock::time_point	m_tp_start;
+		double	m_budget;
+		int		m_simulations = 0;
+		int		m_check_interval = 1;
+		int		m_next_check = 1;
+		struct { int simulations; double elapsed; } m_last_check = { 0, 0 };
+		long	m_start_visits = 0;
+		int		m_moves_in_game = 0;
+		double	m_game_time_used = 0;
+		Average<float>	m_game_moves;
+		Average<float>	m_saved_time;
+		Average<float>	m_early_stop;
+	};
+}
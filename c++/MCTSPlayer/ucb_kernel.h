@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UCB_KERNEL_AVX2
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define UCB_KERNEL_SSE2
+#endif
+#include "MCTSPlayer.h"
+
+namespace MC
+{
+	//selection in tree policy without allocations, works directly on contiguous MoveNode array
+	//score of move = value[player] * probability / (1 + visits) + c_sqrt_log * sqrt(1 / (1 + visits))
+	//where c_sqrt_log = C * sqrt(log(1 + node visits)) is computed once per node
+	namespace UCB
+	{
+		const int MaxMoves = 256;	//StateNode::numMoves is 8 bit
+		//vector lanes and scalar tail scale probability by the same constant, equal moves get bitwise equal scores and tie
+		constexpr float ProbScale = 1.0f / 65535.0f;
+
+		template <typename MoveNode>
+		inline float scalarScore(const MoveNode& mv, int player, float c_sqrt_log)
+		{
+			const float oo_visited = 1.0f / (1.0f + mv.numVisited);
+			return mv.value[player] * (mv.probability * ProbScale) * oo_visited + c_sqrt_log * std::sqrt(oo_visited);
+		}
+
+		template <typename MoveNode>
+		inline void scores(const MoveNode* moves, int num_moves, int player, float c_sqrt_log, float* out)
+		{
+			int mi = 0;
+#if defined(UCB_KERNEL_AVX2)
+			//gather picks the same field from 8 consecutive moves
+			//counter and probability are read as 32 bit words, bytes following them still belong to the same MoveNode
+			using Counter = decltype(MoveNode::numVisited);
+			static_assert(sizeof(Counter) <= 4, "counter must fit in gathered word");
+			static_assert(offsetof(MoveNode, probability) + 4 <= sizeof(MoveNode), "gathered probability word must stay inside MoveNode");
+			const int S = sizeof(MoveNode);
+			const __m256i stride = _mm256_setr_epi32(0, S, 2 * S, 3 * S, 4 * S, 5 * S, 6 * S, 7 * S);
+			const __m256i counter_mask = _mm256_set1_epi32(sizeof(Counter) == 4 ? -1 : (1 << 8 * sizeof(Counter)) - 1);
+			const __m256i word_mask = _mm256_set1_epi32(0xffff);
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 prob_scale = _mm256_set1_ps(ProbScale);
+			const __m256 c = _mm256_set1_ps(c_sqrt_log);
+			const int value_offset = int(offsetof(MoveNode, value)) + 4 * player;
+			for (; mi + 8 <= num_moves; mi += 8)
+			{
+				const char* base = reinterpret_cast<const char*>(moves + mi);
+				const __m256i counters = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + offsetof(MoveNode, numVisited)), stride, 1);
+				const __m256i probs = _mm256_i32gather_epi32(reinterpret_cast<const int*>(base + offsetof(MoveNode, probability)), stride, 1);
+				//32 bit counters are below 2^31 in practice, signed conversion is exact enough
+				const __m256 visited = _mm256_cvtepi32_ps(_mm256_and_si256(counters, counter_mask));
+				const __m256 prob = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(probs, word_mask)), prob_scale);
+				const __m256 value = _mm256_i32gather_ps(reinterpret_cast<const float*>(base + value_offset), stride, 1);
+				const __m256 oo_visited = _mm256_div_ps(one, _mm256_add_ps(one, visited));
+				const __m256 weight = _mm256_mul_ps(_mm256_mul_ps(value, prob), oo_visited);
+				_mm256_storeu_ps(out + mi, _mm256_add_ps(weight, _mm256_mul_ps(c, _mm256_sqrt_ps(oo_visited))));
+			}
+#elif defined(UCB_KERNEL_SSE2)
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 prob_scale = _mm_set1_ps(ProbScale);
+			const __m128 c = _mm_set1_ps(c_sqrt_log);
+			for (; mi + 4 <= num_moves; mi += 4)
+			{
+				const MoveNode* m = moves + mi;
+				const __m128 visited = _mm_setr_ps(float(m[0].numVisited), float(m[1].numVisited), float(m[2].numVisited), float(m[3].numVisited));
+				const __m128 prob = _mm_mul_ps(_mm_setr_ps(m[0].probability, m[1].probability, m[2].probability, m[3].probability), prob_scale);
+				const __m128 value = _mm_setr_ps(m[0].value[player], m[1].value[player], m[2].value[player], m[3].value[player]);
+				const __m128 oo_visited = _mm_div_ps(one, _mm_add_ps(one, visited));
+				const __m128 weight = _mm_mul_ps(_mm_mul_ps(value, prob), oo_visited);
+				_mm_storeu_ps(out + mi, _mm_add_ps(weight, _mm_mul_ps(c, _mm_sqrt_ps(oo_visited))));
+			}
+#endif
+			for (; mi < num_moves; ++mi) {
+				out[mi] = scalarScore(moves[mi], player, c_sqrt_log);
+			}
+		}
+
+		//stores indices of moves with maximal score in decreasing order, returns their number
+		inline int argmaxTies(float* scores, int num_moves, uint8_t* ties)
+		{
+			float best = -std::numeric_limits<float>::infinity();
+			int mi = 0;
+#if defined(UCB_KERNEL_AVX2) || defined(UCB_KERNEL_SSE2)
+			__m128 vbest = _mm_set1_ps(best);
+			for (; mi + 4 <= num_moves; mi += 4) {
+				vbest = _mm_max_ps(vbest, _mm_loadu_ps(scores + mi));
+			}
+			vbest = _mm_max_ps(vbest, _mm_shuffle_ps(vbest, vbest, _MM_SHUFFLE(2, 3, 0, 1)));
+			vbest = _mm_max_ps(vbest, _mm_shuffle_ps(vbest, vbest, _MM_SHUFFLE(1, 0, 3, 2)));
+			best = _mm_cvtss_f32(vbest);
+#endif
+			for (; mi < num_moves; ++mi) {
+				if (scores[mi] > best) best = scores[mi];
+			}
+			int num_ties = 0;
+			mi = num_moves;
+#if defined(UCB_KERNEL_AVX2) || defined(UCB_KERNEL_SSE2)
+			vbest = _mm_set1_ps(best);
+			for (; mi >= 4; mi -= 4)
+			{
+				int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(scores + mi - 4), vbest));
+				for (int lane = 3; lane >= 0; --lane) {
+					if (mask & (1 << lane)) ties[num_ties++] = uint8_t(mi - 4 + lane);
+				}
+			}
+#endif
+			while (mi-- > 0) {
+				if (scores[mi] == best) ties[num_ties++] = uint8_t(mi);
+			}
+			return num_ties;
+		}
+	}
+}
@@ -3,11 +3,14 @@
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/data/monomorphic.hpp>
 #include <boost/dll/import.hpp>
+#include <map>
+#include <set>
 
 #define UNIT_TEST
 #include "../MCTSPlayer/MCTSPlayer.h"
 #include <Trace.h>
 #include "mcts_player_ut_common.h"
+#include "random_generator.h"
 //#include <GameRules.h>
 
 namespace ut = boost::unit_test;
@@ -62,6 +65,30 @@ BOOST_AUTO_TEST_CASE(dump_load_type1)
 	boost::filesystem::remove(filename);
 	boost::filesystem::remove(filename2);
 }
+BOOST_AUTO_TEST_CASE(dump_load_snapshot_type1)
+{
+	auto r = makeGameTree_type3();
+	auto root = r.CreateRandomInitialState(nullptr);
+	player.setGameRules(&r);
+
+	player.runNSimulations(root, 15);
+	const auto root_visits = player.m_root->numVisited;
+	const auto left = player.m_root->moves[0];
+	const char* filename = "C:\\MyData\\Projects\\gra_w_pana\\logs\\test_tree_dump.mcts";
+	player.saveTreeSnapshot(filename, player.m_root);
+	player.freeTree(player.m_root);
+	auto [root2, path] = player.loadTreeSnapshot(filename);
+	player.m_root = root2;
+	//binary format keeps statistics exactly
+	BOOST_TEST(root_visits == player.m_root->numVisited);
+	BOOST_TEST(left.numVisited == player.m_root->moves[0].numVisited);
+	BOOST_TEST(left.value[0] == player.m_root->moves[0].value[0]);
+	BOOST_TEST(left.probability == player.m_root->moves[0].probability);
+	const char* filename2 = "C:\\MyData\\Projects\\gra_w_pana\\logs\\test_tree_dump_2.gv";
+	player.dumpTree(filename2, player.m_root);
+	boost::filesystem::remove(filename);
+	boost::filesystem::remove(filename2);
+}
 BOOST_AUTO_TEST_CASE(expansion_case_1)
 {
 	player.setGameRules(gr);
@@ -96,4 +123,333 @@ BOOST_AUTO_TEST_CASE(dump_load_type1)
 	boost::filesystem::remove(filename);
 	boost::filesystem::remove(filename2);
 }
-BOOST_AUTO_TEST_SUITE_END();
\ No newline at end of file
+BOOST_AUTO_TEST_CASE(dump_load_snapshot_type1)
+{
+	auto r = makeGameTree_type3();
+	auto root = r.CreateRandomInitialState(nullptr);
+	player.setGameRules(&r);
+
+	player.runNSimulations(root, 15);
+	const auto root_visits = player.m_root->numVisited;
+	const auto left = player.m_root->moves[0];
+	const char* filename = "C:\\MyData\\Projects\\gra_w_pana\\logs\\test_tree_dump.mcts";
+	player.saveTreeSnapshot(filename, player.m_root);
+	player.freeTree(player.m_root);
+	auto [root2, path] = player.loadTreeSnapshot(filename);
+	player.m_root = root2;
+	//binary format keeps statistics exactly
+	BOOST_TEST(root_visits == player.m_root->numVisited);
+	BOOST_TEST(left.numVisited == player.m_root->moves[0].numVisited);
+	BOOST_TEST(left.value[0] == player.m_root->moves[0].value[0]);
+	BOOST_TEST(left.probability == player.m_root->moves[0].probability);
+	const char* filename2 = "C:\\MyData\\Projects\\gra_w_pana\\logs\\test_tree_dump_2.gv";
+	player.dumpTree(filename2, player.m_root);
+	boost::filesystem::remove(filename);
+	boost::filesystem::remove(filename2);
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//root parallel search with rules allocating states from their own pools, every tree has to own a separate root state
+BOOST_AUTO_TEST_SUITE(MCTS_Player_root_parallel_pooled_rules);
+BOOST_AUTO_TEST_CASE(separate_root_states)
+{
+	const int num_searchers = 4;
+	const int num_simulations = 200;
+	CreateGameRules_t createGameRules = boost::dll::import_alias<IGameRules*(int number_of_players)>(
+		"GraWPanaZasadyV2",
+		"createGameRules",
+		boost::dll::load_mode::append_decorations);
+	IGameRules* gr = createGameRules(2);
+	GameState* start = gr->CreateStateFromString("S=|P0=10.3h10.3sW.3hW.3dD.3hD.3sD.3dK.3hK.3cA.3hA.3sA.3d|P1=9.3h9.3c9.3s9.3d10.3c10.3dW.3cW.3sD.3cK.3sK.3dA.3c|CP=1");
+	{
+		MC::MCTSConfig cfg{ gr->GetCurrentPlayer(start),2,1,false, 50,2.0,1234,50,"","","", 0.005f };
+		MC::Player player(cfg, new TestSimLimit(num_simulations), createInstance(""));
+		player.setGameRulesFactory(createGameRules);
+		for (int wi = 1; wi < num_searchers; ++wi) {
+			MC::MCTSConfig wcfg = cfg;
+			wcfg.seed = cfg.seed + wi;
+			player.addWorker(new MC::Player(wcfg, new TestSimLimit(num_simulations), createInstance("")));
+		}
+		player.setGameRules(gr);
+
+		//first search creates the roots, second one finds them and releases the copies
+		for (int search = 1; search <= 2; ++search)
+		{
+			player.runNSimulations(gr->CopyGameState(start), num_simulations);
+			std::set<GameState*> root_states{ player.m_root->state };
+			for (auto *worker : player.m_workers) root_states.insert(worker->m_root->state);
+			BOOST_TEST(num_searchers == root_states.size());
+			uint32_t visits = 0;
+			for (auto & mv : player.mergeRootStatistics()) visits += mv.numVisited;
+			BOOST_TEST(search * num_searchers * num_simulations == visits);
+		}
+		for (auto *worker : player.m_workers) worker->freeTree(worker->m_root);
+		player.freeTree(player.m_root);
+	}
+	gr->ReleaseGameState(start);
+	gr->Release();
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//search rate benchmarks below share one measurement, every suite is disabled and run explicitly with --run_test=<suite name>
+//GraWPana starts from a fixed deal, LinesOfAction has single initial position
+struct SearchRate
+{
+	long long	simulations_per_sec = 0;
+	size_t		nodes = 0;			//0 : player does not expose its tree
+	size_t		bytes_per_node = 0;
+	size_t		move_lists = 0;
+};
+inline std::ostream& operator<<(std::ostream& out, const SearchRate& rate)
+{
+	if (rate.nodes) out << " nodes " << rate.nodes << " bytes/node " << rate.bytes_per_node << " move lists " << rate.move_lists;
+	return out << " simulations/sec " << rate.simulations_per_sec;
+}
+static CreateGameRules_t importGameRules(const std::string& provider)
+{
+	return boost::dll::import_alias<IGameRules*(int number_of_players)>(
+		provider,
+		"createGameRules",
+		boost::dll::load_mode::append_decorations);
+}
+static GameState* benchmarkStartState(IGameRules* gr, const std::string& provider)
+{
+	return provider == "GraWPanaZasadyV2"
+		? gr->CreateStateFromString("S=|P0=10.3h10.3sW.3hW.3dD.3hD.3sD.3dK.3hK.3cA.3hA.3sA.3d|P1=9.3h9.3c9.3s9.3d10.3c10.3dW.3cW.3sD.3cK.3sK.3dA.3c|CP=1")
+		: gr->CreateRandomInitialState(nullptr);
+}
+//cfg_modifier adjusts the search configuration, SearchThreads above 1 adds workers with own rules instances
+//player_known_start : search starts from what the player to move knows about the start state
+template <typename Player = MC::Player>
+SearchRate measureSearchRate(const std::string& provider, std::function<void(MC::MCTSConfig&)> cfg_modifier, int num_simulations, bool player_known_start = false)
+{
+	CreateGameRules_t createGameRules = importGameRules(provider);
+	IGameRules* gr = createGameRules(2);
+	GameState* complete = benchmarkStartState(gr, provider);
+	const int player_nbr = gr->GetCurrentPlayer(complete);
+	GameState* start = player_known_start ? gr->CreatePlayerKnownState(complete, player_nbr) : gr->CopyGameState(complete);
+	SearchRate rate;
+	{
+		MC::MCTSConfig cfg{ player_nbr,2,1,false, 50,2.0,1234,50,"","","", 0.005f };
+		if (cfg_modifier) cfg_modifier(cfg);
+		Player player(cfg, new TestSimLimit(num_simulations), createInstance(""));
+		player.setGameRulesFactory(createGameRules);
+		for (int wi = 1; wi < cfg.SearchThreads; ++wi) {
+			MC::MCTSConfig wcfg = cfg;
+			wcfg.seed = cfg.seed + wi;
+			player.addWorker(new Player(wcfg, new TestSimLimit(num_simulations), createInstance("")));
+		}
+		player.setGameRules(gr);
+
+		const auto t0 = MC::CLK::now();
+		player.runNSimulations(gr->CopyGameState(start), num_simulations);
+		const auto useconds = std::chrono::duration_cast<std::chrono::microseconds>(MC::CLK::now() - t0).count();
+		BOOST_TEST(num_simulations == player.m_root->numVisited);
+		rate.simulations_per_sec = num_simulations * 1000000ll / __max(1ll, useconds);
+		rate.nodes = player.m_nodeArena.get_live_count();
+		rate.bytes_per_node = player.m_nodeArena.get_current_usage() / __max(size_t(1), rate.nodes);
+		player.visitTree(player.m_root, ++player.m_curr_visit_id, [&rate](typename Player::StateNode* sn) { if (sn->moveList) ++rate.move_lists; return true; });
+		player.freeTree(player.m_root);
+	}
+	gr->ReleaseGameState(start);
+	gr->ReleaseGameState(complete);
+	gr->Release();
+	return rate;
+}
+//MC::StaticPlayer instantiated inside the rules library, created through its createPlayer export
+static SearchRate measureStaticSearchRate(const std::string& provider, int num_simulations)
+{
+	CreateGameRules_t createGameRules = importGameRules(provider);
+	auto createPlayer = boost::dll::import_alias<IGamePlayer*(int player_number, const PlayerConfig_t&)>(
+		provider,
+		"createPlayer",
+		boost::dll::load_mode::append_decorations);
+	IGameRules* gr = createGameRules(2);
+	GameState* start = benchmarkStartState(gr, provider);
+	SearchRate rate;
+	{
+		PlayerConfig_t pc;
+		pc.put("number_of_players", 2);
+		pc.put("playout_depth", 50);
+		pc.put("explore_exploit_ratio", 2.0f);
+		pc.put("random_seed", 1234);
+		pc.put("move_sim_limit", num_simulations);
+		IGamePlayer* player = createPlayer(gr->GetCurrentPlayer(start), pc);
+		player->setGameRules(gr);
+
+		const auto t0 = MC::CLK::now();
+		MoveList* selected = player->selectMove(start);
+		const auto useconds = std::chrono::duration_cast<std::chrono::microseconds>(MC::CLK::now() - t0).count();
+		BOOST_TEST(1 == gr->GetNumMoves(selected));
+		rate.simulations_per_sec = num_simulations * 1000000ll / __max(1ll, useconds);
+		gr->ReleaseMoveList(selected);
+		player->release();
+	}
+	gr->ReleaseGameState(start);
+	gr->Release();
+	return rate;
+}
+template <int NP, typename Counter>
+void reportNodeLayoutRate(const std::string& provider, int num_simulations)
+{
+	using Player = MC::PlayerT<NP, Counter>;
+	BOOST_TEST_MESSAGE(provider << " players " << NP << " counter bits " << 8 * sizeof(Counter) << " move node bytes " << sizeof(typename Player::MoveNode)
+		<< measureSearchRate<Player>(provider, nullptr, num_simulations));
+}
+
+//scaling of tree parallel search
+BOOST_AUTO_TEST_SUITE(MCTS_Player_tree_parallel_scaling, *ut::disabled());
+BOOST_DATA_TEST_CASE(simulations_per_sec,
+	bdata::make(std::vector<std::string>{ "GraWPanaZasadyV2", "LinesOfActionZasady" }) * bdata::make(std::vector<int>{ 1, 2, 4, 8, 16 }),
+	provider, threads)
+{
+	BOOST_TEST_MESSAGE(provider << " threads " << threads << measureSearchRate(provider, [=](MC::MCTSConfig& cfg) { cfg.SearchThreads = threads; cfg.TreeParallel = true; }, 20000));
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//offline opening book builder, run explicitly with --run_test=MCTS_Player_opening_book_builder
+//long searches from the configured start state and from random deals, every position searched often enough goes to the book
+struct BookRandomGenerator : IRandomGenerator
+{
+	std::default_random_engine generator{ 1234 };
+	std::vector<int> generateUniform(int lower, int upper, int number_of_samples) override
+	{
+		std::uniform_int_distribution<int> distribution(lower, upper);
+		std::vector<int> samples(number_of_samples);
+		for (auto & s : samples) s = distribution(generator);
+		return samples;
+	}
+	void release() override {}
+};
+BOOST_AUTO_TEST_SUITE(MCTS_Player_opening_book_builder, *ut::disabled());
+BOOST_DATA_TEST_CASE(build, bdata::make(std::vector<std::string>{ "GraWPanaZasadyV2", "LinesOfActionZasady" }), provider)
+{
+	const std::map<std::string, std::string> start_states = {
+		{ "GraWPanaZasadyV2", "S=|P0=10.3h10.3sW.3hW.3dD.3hD.3sD.3dK.3hK.3cA.3hA.3sA.3d|P1=9.3h9.3c9.3s9.3d10.3c10.3dW.3cW.3sD.3cK.3sK.3dA.3c|CP=1" },
+		{ "LinesOfActionZasady", "" },	//default initial position
+	};
+	const int num_random_deals = provider == "LinesOfActionZasady" ? 0 : 20;	//LinesOfAction has single initial position
+	const int num_simulations = 200000;
+	const int min_visits = 1000;
+	CreateGameRules_t createGameRules = boost::dll::import_alias<IGameRules*(int number_of_players)>(
+		provider,
+		"createGameRules",
+		boost::dll::load_mode::append_decorations);
+	IGameRules* gr = createGameRules(2);
+	BookRandomGenerator rng;
+	std::vector<GameState*> positions;
+	const auto & start_state = start_states.at(provider);
+	positions.push_back(start_state.empty() ? gr->CreateRandomInitialState(&rng) : gr->CreateStateFromString(start_state));
+	for (int i = 0; i < num_random_deals; ++i) {
+		positions.push_back(gr->CreateRandomInitialState(&rng));
+	}
+	OpeningBookWriter book;
+	for (auto *start : positions)
+	{
+		MC::MCTSConfig cfg{ gr->GetCurrentPlayer(start),2,1,false, 50,2.0,1234,50,"","","", 0.005f };
+		MC::Player player(cfg, new TestSimLimit(num_simulations), createInstance(""));
+		player.setGameRules(gr);
+		player.runNSimulations(gr->CopyGameState(start), num_simulations);
+		player.addToOpeningBook(book, min_visits);
+		player.freeTree(player.m_root);
+		gr->ReleaseGameState(start);
+	}
+	const string filename = "C:\\MyData\\Projects\\gra_w_pana\\logs\\" + provider + "_opening_book.bin";
+	book.write(filename);
+	BOOST_TEST_MESSAGE(provider << " book positions " << book.size() << " written to " << filename);
+	BOOST_TEST(OpeningBook(filename).size() == book.size());
+	gr->Release();
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//playouts with and without tree nodes past the frontier
+BOOST_AUTO_TEST_SUITE(MCTS_Player_playout_rate, *ut::disabled());
+BOOST_DATA_TEST_CASE(simulations_per_sec, bdata::make(std::vector<bool>{ false, true }), light_rollout)
+{
+	BOOST_TEST_MESSAGE("light_rollout " << light_rollout << measureSearchRate("GraWPanaZasadyV2", [=](MC::MCTSConfig& cfg) { cfg.LightRollout = light_rollout; }, 20000));
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//scalar evaluation against batches of leaves, batch size 1 is the sequential search evaluating leaves one by one
+BOOST_AUTO_TEST_SUITE(MCTS_Player_eval_batch_rate, *ut::disabled());
+BOOST_DATA_TEST_CASE(simulations_per_sec, bdata::make(std::vector<int>{ 1, 4, 16, 64 }), batch_size)
+{
+	BOOST_TEST_MESSAGE("eval batch size " << batch_size << measureSearchRate("GraWPanaZasadyV2", [=](MC::MCTSConfig& cfg) { cfg.MaxPlayoutDepth = 20; cfg.EvalBatchSize = batch_size; }, 20000));
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//nodes created in full against nodes expanded on the second visit
+//both searches play out past the new node without tree nodes, so they differ only in memory held by the tree
+BOOST_AUTO_TEST_SUITE(MCTS_Player_lazy_expansion_rate, *ut::disabled());
+BOOST_DATA_TEST_CASE(bytes_per_node, bdata::make(std::vector<bool>{ false, true }), lazy_expansion)
+{
+	BOOST_TEST_MESSAGE("lazy_expansion " << lazy_expansion << measureSearchRate("GraWPanaZasadyV2", [=](MC::MCTSConfig& cfg) { cfg.LightRollout = true; cfg.LazyExpansion = lazy_expansion; }, 20000));
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//node layout instantiations on the same search, 16 bit move counters stay below overflow with 60000 simulations
+BOOST_AUTO_TEST_SUITE(MCTS_Player_node_layout_rate, *ut::disabled());
+BOOST_DATA_TEST_CASE(simulations_per_sec, bdata::make(std::vector<std::string>{ "LinesOfActionZasady", "GraWPanaZasadyV2" }), provider)
+{
+	reportNodeLayoutRate<4, uint32_t>(provider, 60000);
+	reportNodeLayoutRate<2, uint32_t>(provider, 60000);
+	reportNodeLayoutRate<2, uint16_t>(provider, 60000);
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//search of the player known state against search of sampled complete states
+BOOST_AUTO_TEST_SUITE(MCTS_Player_information_set_rate, *ut::disabled());
+BOOST_DATA_TEST_CASE(simulations_per_sec, bdata::make(std::vector<bool>{ false, true }) * bdata::make(std::vector<int>{ 1, 4 }), information_set, threads)
+{
+	BOOST_TEST_MESSAGE("information_set " << information_set << " threads " << threads << measureSearchRate("GraWPanaZasadyV2",
+		[=](MC::MCTSConfig& cfg) { cfg.SearchThreads = threads; cfg.InformationSetSearch = information_set; cfg.TreeParallel = true; }, 20000, true));
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+//virtual IGameRules calls against MCTS instantiated on the rules class
+//both searches add one node per simulation and play out uniformly at random past it with the same depth, ratio and seed
+//the difference is not dispatch alone : MC::Player still finds nodes by state in its transposition table and detects cycles
+//on the path, MC::StaticSearch is plain UCT over a tree without either
+BOOST_AUTO_TEST_SUITE(MCTS_Player_static_rules_rate, *ut::disabled());
+BOOST_DATA_TEST_CASE(simulations_per_sec, bdata::make(std::vector<std::string>{ "LinesOfActionZasady", "GraWPanaZasadyV2" }), provider)
+{
+	BOOST_TEST_MESSAGE(provider << " virtual" << measureSearchRate(provider, [](MC::MCTSConfig& cfg) { cfg.NodesToAppendDuringExpansion = 1; cfg.LightRollout = true; }, 20000));
+	BOOST_TEST_MESSAGE(provider << " static" << measureStaticSearchRate(provider, 20000));
+}
+BOOST_AUTO_TEST_SUITE_END();
+
+#ifdef ENABLE_MCTS_PROFILE
+//phase times are sampled from simulations, so they are only checked to be exported once per move
+BOOST_AUTO_TEST_SUITE(MCTS_Player_search_profile);
+BOOST_AUTO_TEST_CASE(phase_shares_exported)
+{
+	CreateGameRules_t createGameRules = boost::dll::import_alias<IGameRules*(int number_of_players)>(
+		"GraWPanaZasadyV2",
+		"createGameRules",
+		boost::dll::load_mode::append_decorations);
+	IGameRules* gr = createGameRules(2);
+	GameState* start = gr->CreateStateFromString("S=|P0=10.3h10.3sW.3hW.3dD.3hD.3sD.3dK.3hK.3cA.3hA.3sA.3d|P1=9.3h9.3c9.3s9.3d10.3c10.3dW.3cW.3sD.3cK.3sK.3dA.3c|CP=1");
+	{
+		MC::MCTSConfig cfg{ gr->GetCurrentPlayer(start),2,1,false, 50,2.0,1234,50,"","","", 0.005f };
+		MC::Player player(cfg, new TestSimLimit(2000), createInstance(""));
+		player.setGameRules(gr);
+		gr->ReleaseMoveList(player.selectMove(start));
+
+		auto nm = player.getGameStats();
+		for (auto name : { "profile_selection_share", "profile_playout_share", "profile_node_creation_share", "profile_apply_move_share",
+			"profile_evaluation_share", "profile_backpropagation_share", "profile_expansion_share" })
+		{
+			BOOST_TEST_REQUIRE(nm.count(name) == 1);
+			const auto & share = boost::get<Histogram<float>>(nm[name]);
+			BOOST_TEST(1 == share.values.size());
+			BOOST_TEST(share.values.begin()->first >= 0.0f);
+		}
+		BOOST_TEST(0 < boost::get<Histogram<long>>(nm["profile_nodes_allocated"]).values.begin()->first);
+		BOOST_TEST(1 == nm.count("profile_pool_bytes"));
+		player.freeTree(player.m_root);
+	}
+	gr->ReleaseGameState(start);
+	gr->Release();
+}
+BOOST_AUTO_TEST_SUITE_END();
+#endif
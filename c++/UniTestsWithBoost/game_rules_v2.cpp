@@ -4,6 +4,7 @@
 #include <boost/test/data/test_case.hpp>	//required for BOOST_DATA_TEST_CASE
 #include <boost/test/data/monomorphic.hpp>	//required for boost::unit_test::data
 #include <boost/mpl/list.hpp>
+#include <set>
 
 #define _CRTDBG_MAP_ALLOC  
 #define UNIT_TEST
@@ -394,5 +395,79 @@ BOOST_AUTO_TEST_CASE(from_wstring_2)
 	gr.ReleaseGameState(s);
 }
 BOOST_AUTO_TEST_SUITE_END();
+BOOST_AUTO_TEST_SUITE(SampleDeterminization);
+BOOST_AUTO_TEST_CASE(deal_matches_known_state)
+{
+	//player 0 knows own hand only, cards of players 1 and 2 are marked 10 in both their hands
+	GraWPanaGameRules gr(3);
+	GameState* cgs = gr.CreateStateFromString("S=|P0=9.3h9.3s9.3c9.3d10.3h10.3s10.3c10.3d|P1=W.3hW.3sW.3cW.3dD.3hD.3sD.3cD.3d|P2=K.3hK.3sK.3cK.3dA.3hA.3sA.3cA.3d|CP=0");
+	GameState* pks = gr.CreatePlayerKnownState(cgs, 0);
+	BOOST_TEST(uint64_t(pks->hand[1].cards) == uint64_t(pks->hand[2].cards));
+	std::set<uint64_t> deals;
+	for (uint32_t seed = 0; seed < 100; ++seed)
+	{
+		GameState* ds = gr.SampleDeterminization(pks, 0, seed);
+		BOOST_TEST(uint64_t(ds->hand[0].cards) == uint64_t(cgs->hand[0].cards));
+		BOOST_TEST(0 == (ds->hand[1].cards & ds->hand[2].cards));
+		BOOST_TEST(uint64_t(ds->hand[1].cards | ds->hand[2].cards) == GraWPanaGameRules::make11(pks->hand[1].cards));
+		for (int pi = 0; pi < 3; ++pi) {
+			BOOST_TEST(int(ds->hand[pi].count) == int(GraWPanaGameRules::count_cards(ds->hand[pi].cards)));
+		}
+		BOOST_TEST(gr.GetCurrentPlayer(ds) == gr.GetCurrentPlayer(pks));
+		deals.insert(ds->hand[1].cards);
+		gr.ReleaseGameState(ds);
+	}
+	BOOST_TEST(deals.size() > 1);
+	gr.ReleaseGameState(pks);
+	gr.ReleaseGameState(cgs);
+}
+BOOST_AUTO_TEST_CASE(same_seed_same_deal)
+{
+	GraWPanaGameRules gr(3);
+	GameState* cgs = gr.CreateStateFromString("S=|P0=9.3h9.3s9.3c9.3d10.3h10.3s10.3c10.3d|P1=W.3hW.3sW.3cW.3dD.3hD.3sD.3cD.3d|P2=K.3hK.3sK.3cK.3dA.3hA.3sA.3cA.3d|CP=0");
+	GameState* pks = gr.CreatePlayerKnownState(cgs, 0);
+	GameState* ds1 = gr.SampleDeterminization(pks, 0, 1234);
+	GameState* ds2 = gr.SampleDeterminization(pks, 0, 1234);
+	BOOST_TEST(gr.AreEqual(ds1, ds2));
+	gr.ReleaseGameState(ds2);
+	gr.ReleaseGameState(ds1);
+	gr.ReleaseGameState(pks);
+	gr.ReleaseGameState(cgs);
+}
+BOOST_AUTO_TEST_CASE(complete_state_stays)
+{
+	//two players : whatever player 0 does not hold is held by player 1
+	GraWPanaGameRules gr(2);
+	GameState* cgs = gr.CreateStateFromString("S=|P0=10.3h10.3sW.3hW.3dD.3hD.3sD.3dK.3hK.3cA.3hA.3sA.3d|P1=9.3h9.3c9.3s9.3d10.3c10.3dW.3cW.3sD.3cK.3sK.3dA.3c|CP=1");
+	GameState* pks = gr.CreatePlayerKnownState(cgs, 0);
+	GameState* ds = gr.SampleDeterminization(pks, 0, 7);
+	BOOST_TEST(gr.AreEqual(ds, cgs));
+	gr.ReleaseGameState(ds);
+	gr.ReleaseGameState(pks);
+	gr.ReleaseGameState(cgs);
+}
+BOOST_AUTO_TEST_CASE(move_available_in_deal)
+{
+	GraWPanaGameRules gr(3);
+	GameState* cgs = gr.CreateStateFromString("S=|P0=9.3h9.3s9.3c9.3d10.3h10.3s10.3c10.3d|P1=W.3hW.3sW.3cW.3dD.3hD.3sD.3cD.3d|P2=K.3hK.3sK.3cK.3dA.3hA.3sA.3cA.3d|CP=1");
+	GameState* pks = gr.CreatePlayerKnownState(cgs, 0);
+	const Move play_wh{ 0b11ull << 2 * 8, 1, Move::play_cards, 0b10 };
+	const Move take{ 0b11, 1, Move::take_cards, 0b11 };
+	int available = 0;
+	for (uint32_t seed = 0; seed < 100; ++seed)
+	{
+		GameState* ds = gr.SampleDeterminization(pks, 0, seed);
+		const bool held = 0 != (ds->hand[1].cards & play_wh.cards);
+		BOOST_TEST(held == gr.IsMoveAvailable(ds, &play_wh, 1));
+		BOOST_TEST(gr.IsMoveAvailable(ds, &take, 1));
+		if (held) ++available;
+		gr.ReleaseGameState(ds);
+	}
+	BOOST_TEST(available > 0);
+	BOOST_TEST(available < 100);
+	gr.ReleaseGameState(pks);
+	gr.ReleaseGameState(cgs);
+}
+BOOST_AUTO_TEST_SUITE_END();
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -0,0 +1,56 @@
+#include "pch.h"
+#include <boost/test/unit_test.hpp>
+
+#define UNIT_TEST
+#include <node_arena.h>
+
+using Arena_t = NodeArena<32, 1024>;
+
+BOOST_AUTO_TEST_SUITE(node_arena);
+BOOST_AUTO_TEST_CASE(alloc_free_reuse)
+{
+	Arena_t a;
+	auto *p1 = a.alloc(2);
+	auto *p2 = a.alloc(3);
+	BOOST_TEST(p2 == p1 + 2 * 32);
+	BOOST_TEST(a.get_live_count() == 2);
+	BOOST_TEST(a.get_current_usage() == 5 * 32);
+	a.free(p1, 2);
+	BOOST_TEST(a.fragmentation() == 2.0f / 5);
+	BOOST_TEST(a.alloc(3) != p1);
+	BOOST_TEST(a.alloc(2) == p1);
+	BOOST_TEST(a.fragmentation() == 0.0f);
+	BOOST_TEST(a.get_max_usage() == 8 * 32);
+}
+BOOST_AUTO_TEST_CASE(linear_walk)
+{
+	Arena_t a;
+	std::vector<uint8_t*> allocs;
+	//block holds 32 slots, 7 allocations of 5 slots span two blocks
+	for (int i = 0; i < 7; ++i) {
+		allocs.push_back(a.alloc(5));
+		*allocs.back() = uint8_t(i);
+	}
+	BOOST_TEST(a.get_reserved() == 2 * 1024);
+	std::vector<int> seen;
+	a.for_each_allocation([&](uint8_t* p) { seen.push_back(*p); return 5; });
+	BOOST_TEST(seen == std::vector<int>({ 0,1,2,3,4,5,6 }));
+}
+BOOST_AUTO_TEST_CASE(reset_and_swap)
+{
+	Arena_t a, b;
+	auto *p = a.alloc(4);
+	a.alloc(4);
+	b.alloc(2);
+	a.reset();
+	BOOST_TEST(a.get_live_count() == 0);
+	BOOST_TEST(a.alloc(4) == p);
+	a.swap(b);
+	BOOST_TEST(a.get_live_count() == 1);
+	BOOST_TEST(a.get_current_usage() == 2 * 32);
+	BOOST_TEST(a.get_max_usage() == 8 * 32);
+	int visited = 0;
+	b.for_each_allocation([&](uint8_t* q) { BOOST_TEST(q == p); ++visited; return 4; });
+	BOOST_TEST(visited == 1);
+}
+BOOST_AUTO_TEST_SUITE_END();
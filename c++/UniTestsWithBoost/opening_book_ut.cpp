@@ -0,0 +1,54 @@
+#include "pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#define UNIT_TEST
+#include <opening_book.h>
+
+static OpeningBookMove bookMove(float value, uint32_t visits)
+{
+	return { { value, 1.0f - value, 0, 0 }, visits, 65535, 0 };
+}
+
+BOOST_AUTO_TEST_SUITE(opening_book);
+BOOST_AUTO_TEST_CASE(write_find)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "opening_book_ut.bin").string();
+	{
+		OpeningBookWriter w;
+		w.add(300, 10, { bookMove(0.5f, 4), bookMove(0.25f, 6) });
+		w.add(7, 3, { bookMove(1.0f, 3) });
+		w.add(300, 5, { bookMove(0.0f, 5) });	//less visited copy of known position is dropped
+		w.add(7, 8, { bookMove(0.75f, 8) });	//more visited one replaces it
+		BOOST_TEST(2 == w.size());
+		w.write(filename);
+	}
+	{
+		OpeningBook book(filename);
+		BOOST_TEST(2 == book.size());
+		BOOST_TEST(nullptr == book.find(8));
+		BOOST_TEST(nullptr == book.find(301));
+		const auto *e1 = book.find(7);
+		BOOST_TEST_REQUIRE(nullptr != e1);
+		BOOST_TEST(8 == e1->num_visited);
+		BOOST_TEST(1 == e1->num_moves);
+		BOOST_TEST(0.75f == book.moves(*e1)[0].value[0]);
+		const auto *e2 = book.find(300);
+		BOOST_TEST_REQUIRE(nullptr != e2);
+		BOOST_TEST(2 == e2->num_moves);
+		BOOST_TEST(6 == book.moves(*e2)[1].num_visited);
+		BOOST_TEST(0.75f == book.moves(*e2)[1].value[1]);
+	}
+	boost::filesystem::remove(filename);
+}
+BOOST_AUTO_TEST_CASE(invalid_file)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "opening_book_ut_invalid.bin").string();
+	{
+		std::ofstream out(filename, std::ios::binary);
+		out << "not a book file";
+	}
+	BOOST_CHECK_THROW(OpeningBook book(filename), const char*);
+	boost::filesystem::remove(filename);
+}
+BOOST_AUTO_TEST_SUITE_END();
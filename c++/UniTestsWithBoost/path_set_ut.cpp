@@ -0,0 +1,37 @@
+#include "pch.h"
+#include <boost/test/unit_test.hpp>
+
+#define UNIT_TEST
+#include <path_set.h>
+
+struct Node { int id; uint64_t pad; };
+
+BOOST_AUTO_TEST_SUITE(path_set);
+BOOST_AUTO_TEST_CASE(insert_contains_erase)
+{
+	std::vector<Node> nodes(10);
+	PathSet<Node> s(4);
+	for (auto & n : nodes) BOOST_TEST(s.insert(&n));
+	BOOST_TEST(s.size() == 10);
+	BOOST_TEST(!s.insert(&nodes[3]));
+	for (auto & n : nodes) BOOST_TEST(s.contains(&n));
+	//path is unwound from the end
+	for (int i = 9; i >= 5; --i) BOOST_TEST(s.erase(&nodes[i]));
+	for (int i = 0; i < 10; ++i) BOOST_TEST(s.contains(&nodes[i]) == (i < 5));
+	BOOST_TEST(!s.erase(&nodes[7]));
+	s.clear();
+	BOOST_TEST(s.size() == 0);
+	BOOST_TEST(!s.contains(&nodes[0]));
+}
+BOOST_AUTO_TEST_CASE(erase_keeps_probe_chains)
+{
+	//small table with many elements forces collisions, every erase order must keep remaining nodes reachable
+	std::vector<Node> nodes(8);
+	PathSet<Node> s(8);
+	const size_t capacity = s.capacity();
+	for (auto & n : nodes) s.insert(&n);
+	for (int i = 0; i < 8; i += 2) BOOST_TEST(s.erase(&nodes[i]));
+	for (int i = 0; i < 8; ++i) BOOST_TEST(s.contains(&nodes[i]) == (i % 2 == 1));
+	BOOST_TEST(s.capacity() == capacity);
+}
+BOOST_AUTO_TEST_SUITE_END();
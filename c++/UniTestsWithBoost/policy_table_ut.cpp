@@ -0,0 +1,97 @@
+#include "pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#define UNIT_TEST
+#include <policy_table.h>
+
+//record of n bytes, every byte holds the value
+struct TestState
+{
+	uint32_t				key[2];
+	std::vector<uint8_t>	record;
+};
+static TestState testState(uint32_t k0, uint32_t k1, uint8_t value, size_t bytes)
+{
+	return { { k0, k1 }, std::vector<uint8_t>(bytes, value) };
+}
+static std::vector<PolicyRecordRef> recordRefs(const std::vector<TestState>& states)
+{
+	std::vector<PolicyRecordRef> refs;
+	for (auto & s : states) refs.push_back({ s.key, s.record.data(), s.record.size() });
+	return refs;
+}
+
+BOOST_AUTO_TEST_SUITE(policy_table);
+BOOST_AUTO_TEST_CASE(append_find)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "policy_table_ut.bin").string();
+	boost::filesystem::remove(filename);
+	const uint32_t unknown[2] = { 5, 5 };
+	{
+		PolicyTable table(filename, 2);
+		BOOST_TEST(0 == table.size());
+		BOOST_TEST(nullptr == table.find(unknown));
+
+		const std::vector<TestState> states = { testState(9, 1, 1, 12), testState(2, 7, 2, 20), testState(9, 0, 3, 4) };
+		table.append(recordRefs(states));
+		BOOST_TEST(3 == table.size());
+		BOOST_TEST(nullptr == table.find(unknown));
+		auto *r = table.find(states[1].key);
+		BOOST_TEST_REQUIRE(nullptr != r);
+		BOOST_TEST(2 == r[19]);
+		r[0] = 42;	//updated in place
+		table.flush();
+
+		table.append(recordRefs({ testState(5, 6, 4, 8) }));
+		BOOST_TEST(2 == table.numSegments());
+	}
+	{
+		//reopened file keeps both segments and the update
+		PolicyTable table(filename, 2);
+		BOOST_TEST(4 == table.size());
+		const uint32_t k0[2] = { 2, 7 }, k1[2] = { 9, 0 }, k2[2] = { 5, 6 };
+		BOOST_TEST(42 == table.find(k0)[0]);
+		BOOST_TEST(3 == table.find(k1)[3]);
+		BOOST_TEST(4 == table.find(k2)[7]);
+		size_t num_states = 0, num_bytes = 0;
+		table.forEach([&](const uint32_t*, uint8_t*, size_t bytes) { ++num_states; num_bytes += bytes; });
+		BOOST_TEST(4 == num_states);
+		BOOST_TEST(44 == num_bytes);
+	}
+	BOOST_CHECK_THROW(PolicyTable other_hash_size(filename, 3), const char*);
+	boost::filesystem::remove(filename);
+}
+BOOST_AUTO_TEST_CASE(merge_segments)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "policy_table_ut_merge.bin").string();
+	boost::filesystem::remove(filename);
+	{
+		PolicyTable table(filename, 2);
+		for (uint32_t si = 0; si < PolicyTable::MaxSegments; ++si) {
+			table.append(recordRefs({ testState(si, 0, uint8_t(si), 4), testState(si, 1, uint8_t(si), 8) }));
+		}
+		BOOST_TEST(1 == table.numSegments());
+		BOOST_TEST(2 * PolicyTable::MaxSegments == table.size());
+	}
+	PolicyTable table(filename, 2);
+	BOOST_TEST(2 * PolicyTable::MaxSegments == table.size());
+	for (uint32_t si = 0; si < PolicyTable::MaxSegments; ++si)
+	{
+		const uint32_t k[2] = { si, 1 };
+		auto *r = table.find(k);
+		BOOST_TEST_REQUIRE(nullptr != r);
+		BOOST_TEST(si == r[7]);
+	}
+}
+BOOST_AUTO_TEST_CASE(invalid_file)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "policy_table_ut_invalid.bin").string();
+	{
+		std::ofstream out(filename, std::ios::binary);
+		out << "not a policy file";
+	}
+	BOOST_CHECK_THROW(PolicyTable table(filename, 2), const char*);
+	boost::filesystem::remove(filename);
+}
+BOOST_AUTO_TEST_SUITE_END();
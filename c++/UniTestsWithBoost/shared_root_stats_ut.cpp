@@ -0,0 +1,103 @@
+#include "pch.h"
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#define UNIT_TEST
+#include <shared_root_stats.h>
+
+static std::vector<SharedRootMove> rootMoves(uint32_t num_moves, uint32_t visits)
+{
+	std::vector<SharedRootMove> moves(num_moves);
+	for (uint32_t mi = 0; mi < num_moves; ++mi) {
+		moves[mi] = { { 0.5f * visits, 0.25f * visits, 0, 0 }, visits + mi, 65535, 0 };
+	}
+	return moves;
+}
+
+BOOST_AUTO_TEST_SUITE(shared_root_stats);
+BOOST_AUTO_TEST_CASE(publish_read)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "shared_root_stats_ut.bin").string();
+	boost::filesystem::remove(filename);
+	{
+		//separate mappings of one file, as two processes have them
+		SharedRootStats coordinator(filename, 2);
+		SharedRootStats worker(filename, 2);
+		uint32_t num_visited = 0;
+		std::vector<SharedRootMove> moves;
+		BOOST_TEST(!coordinator.read(1, 77, num_visited, moves));
+
+		const auto published = rootMoves(3, 10);
+		worker.publish(1, 77, 33, published.data(), 3);
+		BOOST_TEST(1 == coordinator.numPublishes(1));
+		BOOST_TEST(!coordinator.read(1, 78, num_visited, moves));	//other position
+		BOOST_TEST_REQUIRE(coordinator.read(1, 77, num_visited, moves));
+		BOOST_TEST(33 == num_visited);
+		BOOST_TEST_REQUIRE(3 == moves.size());
+		BOOST_TEST(12 == moves[2].num_visited);
+		BOOST_TEST(2.5f == moves[1].value[1]);
+	}
+	{
+		//existing file is kept
+		SharedRootStats again(filename, 2);
+		uint32_t num_visited = 0;
+		std::vector<SharedRootMove> moves;
+		BOOST_TEST(again.read(1, 77, num_visited, moves));
+	}
+	BOOST_CHECK_THROW(SharedRootStats wrong_size(filename, 3), const char*);
+	boost::filesystem::remove(filename);
+}
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(forked_publishers)
+{
+	const auto filename = (boost::filesystem::temp_directory_path() / "shared_root_stats_ut_fork.bin").string();
+	boost::filesystem::remove(filename);
+	const uint32_t num_workers = 3;
+	const uint32_t num_publishes = 1000;
+	std::vector<pid_t> workers;
+	for (uint32_t wi = 1; wi <= num_workers; ++wi)
+	{
+		const pid_t pid = fork();
+		if (0 == pid)
+		{
+			SharedRootStats stats(filename, num_workers + 1);
+			for (uint32_t pi = 1; pi <= num_publishes; ++pi) {
+				const auto moves = rootMoves(wi + 1, pi);
+				stats.publish(wi, 77, pi * wi, moves.data(), wi + 1);
+			}
+			_exit(0);
+		}
+		workers.push_back(pid);
+	}
+	SharedRootStats coordinator(filename, num_workers + 1);
+	//slots are read while workers keep writing them, every successful read is one whole publish
+	uint32_t num_visited = 0;
+	std::vector<SharedRootMove> moves;
+	for (int ri = 0; ri < 1000; ++ri) {
+		for (uint32_t wi = 1; wi <= num_workers; ++wi) {
+			if (coordinator.read(wi, 77, num_visited, moves)) {
+				BOOST_TEST(wi + 1 == moves.size());
+				BOOST_TEST(num_visited == moves[0].num_visited * wi);
+			}
+		}
+	}
+	for (auto pid : workers) {
+		int status = 0;
+		waitpid(pid, &status, 0);
+		BOOST_TEST(0 == status);
+	}
+	for (uint32_t wi = 1; wi <= num_workers; ++wi)
+	{
+		BOOST_TEST(num_publishes == coordinator.numPublishes(wi));
+		BOOST_TEST_REQUIRE(coordinator.read(wi, 77, num_visited, moves));
+		BOOST_TEST(num_publishes * wi == num_visited);
+		BOOST_TEST(wi + 1 == moves.size());
+	}
+	boost::filesystem::remove(filename);
+}
+#endif
+BOOST_AUTO_TEST_SUITE_END();
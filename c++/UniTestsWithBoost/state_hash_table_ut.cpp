@@ -0,0 +1,66 @@
+#include "pch.h"
+#include <boost/test/unit_test.hpp>
+
+#define UNIT_TEST
+#include <state_hash_table.h>
+
+struct Node { int id; };
+
+BOOST_AUTO_TEST_SUITE(state_hash_table);
+BOOST_AUTO_TEST_CASE(insert_find)
+{
+	StateHashTable<Node> t(16);
+	Node n1{ 1 }, n2{ 2 };
+	t.insert(5, &n1);
+	t.insert(21, &n2);	//same home slot as 5
+	auto any = [](const Node*) { return true; };
+	BOOST_TEST(t.find(5, any) == &n1);
+	BOOST_TEST(t.find(21, any) == &n2);
+	BOOST_TEST(t.find(37, any) == nullptr);
+	BOOST_TEST(t.size() == 2);
+}
+BOOST_AUTO_TEST_CASE(colliding_digest)
+{
+	StateHashTable<Node> t(16);
+	Node n1{ 1 }, n2{ 2 };
+	t.insert(7, &n1);
+	t.insert(7, &n2);
+	BOOST_TEST(t.find(7, [](const Node* n) { return n->id == 2; }) == &n2);
+	BOOST_TEST(t.erase(7, &n1));
+	BOOST_TEST(t.find(7, [](const Node* n) { return n->id == 1; }) == nullptr);
+	BOOST_TEST(t.find(7, [](const Node* n) { return n->id == 2; }) == &n2);
+}
+BOOST_AUTO_TEST_CASE(erase_shifts_back)
+{
+	StateHashTable<Node> t(16);
+	Node n[4] = { {0},{1},{2},{3} };
+	t.insert(3, &n[0]);
+	t.insert(19, &n[1]);	//home 3, stored at 4
+	t.insert(4, &n[2]);		//home 4, stored at 5
+	t.insert(35, &n[3]);	//home 3, stored at 6
+	BOOST_TEST(t.erase(3, &n[0]));
+	BOOST_TEST(!t.erase(3, &n[0]));
+	auto any = [](const Node*) { return true; };
+	BOOST_TEST(t.find(19, any) == &n[1]);
+	BOOST_TEST(t.find(4, any) == &n[2]);
+	BOOST_TEST(t.find(35, any) == &n[3]);
+	BOOST_TEST(t.size() == 3);
+}
+BOOST_AUTO_TEST_CASE(grow)
+{
+	StateHashTable<Node> t(16);
+	std::vector<Node> nodes(1000);
+	for (int i = 0; i < 1000; ++i) {
+		nodes[i].id = i;
+		t.insert(hashStateWords(reinterpret_cast<const uint32_t*>(&i), 1), &nodes[i]);
+	}
+	BOOST_TEST(t.load_factor() <= 0.5f);
+	for (int i = 0; i < 1000; ++i) {
+		const auto key = hashStateWords(reinterpret_cast<const uint32_t*>(&i), 1);
+		BOOST_TEST(t.find(key, [i](const Node* n) { return n->id == i; }) == &nodes[i]);
+		if (i % 2) t.erase(key, &nodes[i]);
+	}
+	BOOST_TEST(t.size() == 500);
+	BOOST_TEST(t.average_probe_length() < 2.0f);
+}
+BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,8 @@ struct GameState;
 struct Move;
 struct MoveList;
 using EvalFunction_t = std::function<void(const GameState*, int score[])>;
+//evaluates count states in one call, scores of states[i] start at scores[4 * i]
+using BatchEvalFunction_t = std::function<void(const GameState* const states[], int count, int scores[])>;
 struct IGameRules
 {
 	virtual void		SetRandomGenerator			(IRandomGenerator*) = 0;
@@ -20,7 +22,19 @@ struct IGameRules
 	virtual GameState*	CreateStateFromString		(const string&) = 0;
 	virtual GameState*	CreatePlayerKnownState		(const GameState*, int playerNum) = 0;
 	virtual EvalFunction_t CreateEvalFunction(const string& name) = 0;
+	//rules without vectorized evaluator evaluate the batch state by state
+	virtual BatchEvalFunction_t CreateBatchEvalFunction(const string& name)
+	{
+		return [eval = CreateEvalFunction(name)](const GameState* const states[], int count, int scores[]) {
+			for (int i = 0; i < count; ++i) eval(states[i], scores + 4 * i);
+		};
+	}
 	virtual void		UpdatePlayerKnownState		(GameState* playerKnownState, const GameState* completeGameState, const std::vector<MoveList*>& playerMoves) = 0;
+	//information set search : complete state consistent with what playerNum knows, same seed gives the same state
+	//in games of perfect information player known state is already complete
+	virtual GameState*	SampleDeterminization		(const GameState* playerKnownState, int playerNum, uint32_t seed) { return CopyGameState(playerKnownState); }
+	//move listed for player known state may be impossible in a determinization, ex: card is held by other player
+	virtual bool		IsMoveAvailable				(const GameState* determinization, const Move*, int playerNum) { return true; }
 	virtual GameState*	CopyGameState				(const GameState*) = 0;
 	virtual bool		AreEqual					(const GameState*, const GameState*) = 0;
 	virtual void		ReleaseGameState			(GameState*) = 0;
@@ -32,6 +32,7 @@ struct GameState
 	bool isTerminal;
 	int score[4];
 	map<int, MoveList> playerMoves;
+	mutable uint32_t hash[2];
 };
 
 struct TestGameRules: IGameRules
@@ -51,9 +52,14 @@ struct TestGameRules: IGameRules
 	{
 		return &m_tree[0];
 	}
-	GameState* CreateInitialStateFromHash(const uint32_t*) override
+	GameState* CreateInitialStateFromHash(const uint32_t* hash) override
 	{
-		throw "not implemented";
+		//used by tree snapshots, every state of the tree is already in m_tree
+		auto it = std::find_if(m_tree.begin(), m_tree.end(), [&](const GameState& gs) {
+			const uint32_t *h = GetStateHash(&gs);
+			return h[0] == hash[0] && h[1] == hash[1];
+			});
+		return &*it;
 	}
 	GameState* CreatePlayerKnownState(const GameState*, int playerNum) override
 	{
@@ -61,7 +67,8 @@ struct TestGameRules: IGameRules
 	}
 	EvalFunction_t CreateEvalFunction(const string& name)
 	{
-		throw "not implemented";
+		//non-terminal leaves are evaluated as a draw
+		return [](const GameState*, int score[]) { for (int i = 0; i < 4; ++i) score[i] = 50; };
 	}
 	void UpdatePlayerKnownState(GameState* playerKnownState, const GameState* completeGameState, const std::vector<MoveList*>& playerMoves) override
 	{
@@ -79,9 +86,10 @@ struct TestGameRules: IGameRules
 	{
 		throw "not implemented";
 	}
-	GameState* CopyGameState(const GameState*) override
+	GameState* CopyGameState(const GameState* s) override
 	{
-		throw "not implemented";
+		//states are nodes of m_tree, never modified nor released
+		return const_cast<GameState*>(s);
 	}
 	bool AreEqual(const GameState* a, const GameState* b) override
 	{
@@ -144,7 +152,11 @@ struct TestGameRules: IGameRules
 	}
 	const uint32_t* GetStateHash(const GameState* s) override
 	{
-		return reinterpret_cast<const uint32_t*>(s);
+		//states are identified by name, same as in AreEqual
+		const uint64_t h = std::hash<wstring>()(s->name);
+		s->hash[0] = uint32_t(h);
+		s->hash[1] = uint32_t(h >> 32);
+		return s->hash;
 	}
 	size_t GetStateHashSize() override
 	{
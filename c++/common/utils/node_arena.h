@@ -0,0 +1,125 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+//bump pointer arena for variable size nodes built from fixed size slots
+//freed allocations are kept on per size free lists and reused, the first pointer-size bytes of freed memory hold the list link
+//all allocations are dropped at once by reset(), blocks are kept for the next generation
+template <int SLOT_SIZE, int BLOCK_SIZE>
+struct NodeArena
+{
+	static const int SlotSize = SLOT_SIZE;
+	static const int BlockSize = BLOCK_SIZE;
+	static_assert(SLOT_SIZE >= sizeof(void*), "slot must hold free list link");
+
+	struct Block
+	{
+		uint8_t *start;
+		size_t	used;
+	};
+
+	NodeArena() {}
+	NodeArena(const NodeArena&) = delete;
+	NodeArena& operator=(const NodeArena&) = delete;
+	~NodeArena()
+	{
+		for (auto & b : blocks) {
+			delete[] b.start;
+		}
+	}
+
+	uint8_t* alloc(size_t num_slots)
+	{
+		const size_t size = num_slots * SLOT_SIZE;
+		live_bytes += size;
+		++live_count;
+		max_usage = __max(max_usage, live_bytes);
+		if (num_slots < free_lists.size() && free_lists[num_slots])
+		{
+			uint8_t *ptr = free_lists[num_slots];
+			free_lists[num_slots] = *reinterpret_cast<uint8_t**>(ptr);
+			free_bytes -= size;
+			return ptr;
+		}
+		if (current == blocks.size() || blocks[current].used + size > BLOCK_SIZE)
+		{
+			if (current < blocks.size()) ++current;
+			if (current == blocks.size()) {
+				blocks.push_back({ new uint8_t[BLOCK_SIZE], 0 });
+			}
+		}
+		Block & b = blocks[current];
+		uint8_t *ptr = b.start + b.used;
+		b.used += size;
+		return ptr;
+	}
+
+	void free(uint8_t* ptr, size_t num_slots)
+	{
+		const size_t size = num_slots * SLOT_SIZE;
+		live_bytes -= size;
+		--live_count;
+		free_bytes += size;
+		if (num_slots >= free_lists.size()) {
+			free_lists.resize(num_slots + 1, nullptr);
+		}
+		*reinterpret_cast<uint8_t**>(ptr) = free_lists[num_slots];
+		free_lists[num_slots] = ptr;
+	}
+
+	//visits every allocation made since last reset, including freed ones
+	//visit returns number of slots of the allocation it was given, so the walk can continue
+	template <typename Visit>
+	void for_each_allocation(Visit visit)
+	{
+		for (size_t bi = 0; bi < used_blocks(); ++bi) {
+			for_each_allocation_in_block(bi, visit);
+		}
+	}
+	//allows to split the walk into steps
+	template <typename Visit>
+	void for_each_allocation_in_block(size_t block_idx, Visit visit)
+	{
+		const Block & b = blocks[block_idx];
+		for (size_t offset = 0; offset < b.used; ) {
+			offset += visit(b.start + offset) * SLOT_SIZE;
+		}
+	}
+	size_t used_blocks() const		{ return blocks.empty() ? 0 : current + 1; }
+
+	void reset()
+	{
+		for (size_t bi = 0; bi < used_blocks(); ++bi) {
+			blocks[bi].used = 0;
+		}
+		current = 0;
+		std::fill(free_lists.begin(), free_lists.end(), nullptr);
+		live_bytes = live_count = free_bytes = 0;
+	}
+
+	void swap(NodeArena& other)
+	{
+		std::swap(blocks, other.blocks);
+		std::swap(current, other.current);
+		std::swap(free_lists, other.free_lists);
+		std::swap(live_bytes, other.live_bytes);
+		std::swap(live_count, other.live_count);
+		std::swap(free_bytes, other.free_bytes);
+		max_usage = other.max_usage = __max(max_usage, other.max_usage);
+	}
+
+	void reset_stats()				{ max_usage = live_bytes; }
+	size_t get_max_usage() const	{ return max_usage; }
+	size_t get_current_usage() const{ return live_bytes; }
+	size_t get_live_count() const	{ return live_count; }
+	size_t get_reserved() const		{ return blocks.size() * BLOCK_SIZE; }
+	//part of handed out memory which is freed but not yet reused
+	float fragmentation() const		{ return live_bytes + free_bytes > 0 ? float(free_bytes) / (live_bytes + free_bytes) : 0.0f; }
+
+protected:
+	std::vector<Block>		blocks;
+	size_t					current = 0;
+	std::vector<uint8_t*>	free_lists;		//index = number of slots
+	size_t live_bytes = 0, live_count = 0, free_bytes = 0, max_usage = 0;
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//root statistics of long searches keyed by 64 bit state digest (see hashStateWords)
+//file : header, entries sorted by key, moves of all entries
+//book is mapped read-only, so one instance can be shared by all search threads without copying or locking
+#pragma pack (push,1)
+struct OpeningBookHeader
+{
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	num_entries;
+	uint32_t	num_moves;
+};
+struct OpeningBookEntry
+{
+	uint64_t	key;
+	uint32_t	first_move;
+	uint32_t	num_visited;
+	uint8_t		num_moves;
+	uint8_t		pad[3];
+};
+struct OpeningBookMove
+{
+	float		value[4];		//sum of backpropagated values, as in MoveNode
+	uint32_t	num_visited;
+	uint16_t	probability;	//MoveNode encoding, 65535 = 1.0
+	uint16_t	pad;
+};
+#pragma pack(pop)
+
+struct OpeningBook
+{
+	static const uint32_t Version = 1;
+	static constexpr char Magic[4] = { 'M','C','T','B' };
+
+	explicit OpeningBook(const std::string& filename) :
+		file(filename.c_str(), boost::interprocess::read_only),
+		region(file, boost::interprocess::read_only)
+	{
+		const auto *begin = static_cast<const uint8_t*>(region.get_address());
+		const size_t size = region.get_size();
+		if (size < sizeof(OpeningBookHeader)) throw "invalid_file_format";
+		const auto & header = *reinterpret_cast<const OpeningBookHeader*>(begin);
+		if (!std::equal(Magic, Magic + 4, header.magic) || header.version != Version) throw "invalid_file_format";
+		if (size != sizeof(OpeningBookHeader) + header.num_entries * sizeof(OpeningBookEntry) + header.num_moves * sizeof(OpeningBookMove)) throw "invalid_file_format";
+		entries = reinterpret_cast<const OpeningBookEntry*>(begin + sizeof(OpeningBookHeader));
+		num_entries = header.num_entries;
+		all_moves = reinterpret_cast<const OpeningBookMove*>(entries + num_entries);
+	}
+	OpeningBook(const OpeningBook&) = delete;
+	OpeningBook& operator=(const OpeningBook&) = delete;
+
+	const OpeningBookEntry* find(uint64_t key) const
+	{
+		const auto *it = std::lower_bound(entries, entries + num_entries, key, [](const OpeningBookEntry& e, uint64_t k) { return e.key < k; });
+		return it != entries + num_entries && it->key == key ? it : nullptr;
+	}
+	const OpeningBookMove* moves(const OpeningBookEntry& entry) const { return all_moves + entry.first_move; }
+	size_t size() const { return num_entries; }
+
+protected:
+	boost::interprocess::file_mapping	file;
+	boost::interprocess::mapped_region	region;
+	const OpeningBookEntry	*entries = nullptr;
+	const OpeningBookMove	*all_moves = nullptr;
+	size_t					num_entries = 0;
+};
+
+//collects statistics of searched positions, the same position found again keeps the better searched entry
+struct OpeningBookWriter
+{
+	void add(uint64_t key, uint32_t num_visited, const std::vector<OpeningBookMove>& moves)
+	{
+		auto it = positions.find(key);
+		if (it == positions.end() || it->second.first < num_visited) {
+			positions[key] = { num_visited, moves };
+		}
+	}
+	size_t size() const { return positions.size(); }
+
+	void write(const std::string& filename) const
+	{
+		OpeningBookHeader header{ {}, OpeningBook::Version, uint32_t(positions.size()), 0 };
+		std::copy(OpeningBook::Magic, OpeningBook::Magic + 4, header.magic);
+		std::vector<OpeningBookEntry> entries;
+		std::vector<OpeningBookMove> moves;
+		//map keeps keys sorted, as the binary search of OpeningBook::find needs
+		for (auto & [key, position] : positions)
+		{
+			entries.push_back({ key, uint32_t(moves.size()), position.first, uint8_t(position.second.size()), {} });
+			moves.insert(moves.end(), position.second.begin(), position.second.end());
+		}
+		header.num_moves = uint32_t(moves.size());
+		std::ofstream out(filename, std::ios::binary);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(OpeningBookEntry));
+		out.write(reinterpret_cast<const char*>(moves.data()), moves.size() * sizeof(OpeningBookMove));
+	}
+
+protected:
+	std::map<uint64_t, std::pair<uint32_t, std::vector<OpeningBookMove>>>	positions;
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+//set of nodes on the current simulation path, loop detection without writing into the nodes
+//open addressing with linear probing on the node address, erase uses backward shift like StateHashTable
+//capacity is kept at least twice the number of elements, so after the first simulations it never allocates
+template <typename T>
+struct PathSet
+{
+	PathSet(size_t max_path_length = 32)
+	{
+		size_t capacity = 16;
+		while (capacity < 2 * max_path_length) capacity <<= 1;
+		slots.assign(capacity, nullptr);
+		mask = capacity - 1;
+	}
+
+	//returns false when node is already on the path
+	bool insert(const T* node)
+	{
+		if (2 * (num_entries + 1) > slots.size()) {
+			grow();
+		}
+		size_t idx = home(node);
+		for (; nullptr != slots[idx]; idx = (idx + 1) & mask) {
+			if (slots[idx] == node) return false;
+		}
+		slots[idx] = node;
+		++num_entries;
+		return true;
+	}
+
+	bool contains(const T* node) const
+	{
+		for (size_t idx = home(node); nullptr != slots[idx]; idx = (idx + 1) & mask) {
+			if (slots[idx] == node) return true;
+		}
+		return false;
+	}
+
+	bool erase(const T* node)
+	{
+		size_t hole = home(node);
+		for (;; hole = (hole + 1) & mask)
+		{
+			if (nullptr == slots[hole]) return false;
+			if (slots[hole] == node) break;
+		}
+		for (size_t idx = (hole + 1) & mask; nullptr != slots[idx]; idx = (idx + 1) & mask)
+		{
+			const size_t h = home(slots[idx]);
+			if (((idx - h) & mask) >= ((idx - hole) & mask)) {
+				slots[hole] = slots[idx];
+				hole = idx;
+			}
+		}
+		slots[hole] = nullptr;
+		--num_entries;
+		return true;
+	}
+
+	void clear()
+	{
+		std::fill(slots.begin(), slots.end(), nullptr);
+		num_entries = 0;
+	}
+
+	size_t size() const		{ return num_entries; }
+	size_t capacity() const	{ return slots.size(); }
+
+protected:
+	size_t home(const T* node) const
+	{
+		//nodes are at least 8 byte aligned, fibonacci hashing spreads the remaining bits
+		return size_t((reinterpret_cast<uintptr_t>(node) >> 3) * 0x9e3779b97f4a7c15ull >> 32) & mask;
+	}
+	void grow()
+	{
+		std::vector<const T*> old(slots.size() * 2, nullptr);
+		old.swap(slots);
+		mask = slots.size() - 1;
+		num_entries = 0;
+		for (auto *node : old) {
+			if (node) insert(node);
+		}
+	}
+	std::vector<const T*> slots;
+	size_t mask;
+	size_t num_entries = 0;
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//states learned by a table based player, keyed by the full state hash of the rules (hash_size 32 bit words)
+//file : header, segments appended one after another, segment : header, index sorted by key, records in index order
+//index entry : record offset within the segment records followed by the key, records are opaque to the table
+//file is mapped read-write, so statistics of loaded states are updated in place and only new states are appended
+#pragma pack (push,1)
+struct PolicyFileHeader
+{
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	hash_size;
+	uint32_t	num_segments;
+	uint64_t	file_bytes;		//bytes after the last complete segment, interrupted append is ignored
+};
+struct PolicySegmentHeader
+{
+	uint64_t	num_entries;
+	uint64_t	record_bytes;
+};
+#pragma pack(pop)
+
+struct PolicyRecordRef
+{
+	const uint32_t	*key;
+	const uint8_t	*data;
+	size_t			bytes;
+};
+
+struct PolicyTable
+{
+	static const uint32_t Version = 1;
+	static constexpr uint32_t MaxSegments = 16;	//next append merges all segments into one
+	static constexpr char Magic[4] = { 'M','C','R','L' };
+
+	//missing file is created empty
+	PolicyTable(const std::string& filename, uint32_t hash_size) : filename(filename), hash_size(hash_size)
+	{
+		if (!std::ifstream(filename, std::ios::binary)) {
+			writeFile(filename, {});
+		}
+		map();
+	}
+	PolicyTable(const PolicyTable&) = delete;
+	PolicyTable& operator=(const PolicyTable&) = delete;
+
+	//record of the state or nullptr, binary search in every segment
+	uint8_t* find(const uint32_t* key) const
+	{
+		for (auto & segment : segments)
+		{
+			size_t first = 0, count = segment.num_entries;
+			while (count > 0)
+			{
+				const size_t step = count / 2;
+				if (compare(entryKey(segment, first + step), key) < 0) {
+					first += step + 1;
+					count -= step + 1;
+				}
+				else count = step;
+			}
+			if (first < segment.num_entries && 0 == compare(entryKey(segment, first), key)) {
+				return segment.records + recordOffset(segment, first);
+			}
+		}
+		return nullptr;
+	}
+	//f(key, record, bytes) for all states of the file
+	template<class F>
+	void forEach(F f) const
+	{
+		for (auto & segment : segments) {
+			for (size_t ei = 0; ei < segment.num_entries; ++ei) {
+				f(entryKey(segment, ei), segment.records + recordOffset(segment, ei), recordBytes(segment, ei));
+			}
+		}
+	}
+	//states not in the file yet, records are copied, pointers returned by find before the call are invalidated
+	void append(std::vector<PolicyRecordRef> records)
+	{
+		if (records.empty()) return;
+		if (segments.size() + 1 >= MaxSegments)
+		{
+			forEach([&](const uint32_t* key, uint8_t* data, size_t bytes) { records.push_back({ key, data, bytes }); });
+			const std::string tmp_filename = filename + ".tmp";
+			writeFile(tmp_filename, std::move(records));
+			unmap();
+			std::remove(filename.c_str());
+			if (0 != std::rename(tmp_filename.c_str(), filename.c_str())) throw "rename_failed";
+		}
+		else
+		{
+			unmap();
+			std::fstream out(filename, std::ios::in | std::ios::out | std::ios::binary);
+			PolicyFileHeader header;
+			out.read(reinterpret_cast<char*>(&header), sizeof(header));
+			out.seekp(header.file_bytes);
+			header.file_bytes += writeSegment(out, std::move(records));
+			++header.num_segments;
+			//header goes last, segment is part of the file only when whole written
+			out.seekp(0);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.close();
+			if (!out) throw "write_failed";
+		}
+		map();
+	}
+	//modified records reach the file
+	void flush() { region.flush(); }
+	size_t size() const
+	{
+		size_t num_entries = 0;
+		for (auto & segment : segments) num_entries += segment.num_entries;
+		return num_entries;
+	}
+	size_t numSegments() const { return segments.size(); }
+
+protected:
+	struct Segment
+	{
+		size_t			num_entries;
+		size_t			record_bytes;
+		const uint8_t	*index;
+		uint8_t			*records;
+	};
+	size_t entryBytes() const { return sizeof(uint64_t) + hash_size * sizeof(uint32_t); }
+	const uint32_t* entryKey(const Segment& segment, size_t ei) const { return reinterpret_cast<const uint32_t*>(segment.index + ei * entryBytes() + sizeof(uint64_t)); }
+	size_t recordOffset(const Segment& segment, size_t ei) const
+	{
+		uint64_t offset;
+		std::memcpy(&offset, segment.index + ei * entryBytes(), sizeof(offset));
+		return size_t(offset);
+	}
+	size_t recordBytes(const Segment& segment, size_t ei) const
+	{
+		return (ei + 1 < segment.num_entries ? recordOffset(segment, ei + 1) : segment.record_bytes) - recordOffset(segment, ei);
+	}
+	int compare(const uint32_t* a, const uint32_t* b) const
+	{
+		for (uint32_t wi = 0; wi < hash_size; ++wi) {
+			if (a[wi] != b[wi]) return a[wi] < b[wi] ? -1 : 1;
+		}
+		return 0;
+	}
+
+	void map()
+	{
+		file = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_write);
+		region = boost::interprocess::mapped_region(file, boost::interprocess::read_write);
+		auto *begin = static_cast<uint8_t*>(region.get_address());
+		const size_t size = region.get_size();
+		if (size < sizeof(PolicyFileHeader)) throw "invalid_file_format";
+		const auto & header = *reinterpret_cast<const PolicyFileHeader*>(begin);
+		if (!std::equal(Magic, Magic + 4, header.magic) || header.version != Version || header.hash_size != hash_size || header.file_bytes > size) throw "invalid_file_format";
+		//only segment headers are read, states are paged in by lookups
+		segments.clear();
+		size_t pos = sizeof(PolicyFileHeader);
+		for (uint32_t si = 0; si < header.num_segments; ++si)
+		{
+			if (pos + sizeof(PolicySegmentHeader) > header.file_bytes) throw "invalid_file_format";
+			const auto & segment_header = *reinterpret_cast<const PolicySegmentHeader*>(begin + pos);
+			Segment segment{ size_t(segment_header.num_entries), size_t(segment_header.record_bytes), begin + pos + sizeof(PolicySegmentHeader), nullptr };
+			segment.records = begin + pos + sizeof(PolicySegmentHeader) + segment.num_entries * entryBytes();
+			pos = segment.records + segment.record_bytes - begin;
+			if (pos > header.file_bytes) throw "invalid_file_format";
+			segments.push_back(segment);
+		}
+	}
+	void unmap()
+	{
+		segments.clear();
+		region = boost::interprocess::mapped_region();
+		file = boost::interprocess::file_mapping();
+	}
+	//bytes written
+	size_t writeSegment(std::ostream& out, std::vector<PolicyRecordRef> records) const
+	{
+		std::sort(records.begin(), records.end(), [this](const PolicyRecordRef& a, const PolicyRecordRef& b) { return compare(a.key, b.key) < 0; });
+		PolicySegmentHeader header{ records.size(), 0 };
+		for (auto & record : records) header.record_bytes += record.bytes;
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		uint64_t offset = 0;
+		for (auto & record : records)
+		{
+			out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+			out.write(reinterpret_cast<const char*>(record.key), hash_size * sizeof(uint32_t));
+			offset += record.bytes;
+		}
+		for (auto & record : records) {
+			out.write(reinterpret_cast<const char*>(record.data), record.bytes);
+		}
+		return sizeof(header) + records.size() * entryBytes() + size_t(header.record_bytes);
+	}
+	void writeFile(const std::string& name, std::vector<PolicyRecordRef> records) const
+	{
+		PolicyFileHeader header{ {}, Version, hash_size, 0, sizeof(PolicyFileHeader) };
+		std::copy(Magic, Magic + 4, header.magic);
+		std::ofstream out(name, std::ios::binary);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if (!records.empty()) {
+			header.file_bytes += writeSegment(out, std::move(records));
+			header.num_segments = 1;
+			out.seekp(0);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		}
+		out.close();
+		if (!out) throw "write_failed";
+	}
+
+	const std::string	filename;
+	const uint32_t		hash_size;
+	boost::interprocess::file_mapping	file;
+	boost::interprocess::mapped_region	region;
+	std::vector<Segment>	segments;
+};
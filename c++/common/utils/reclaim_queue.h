@@ -0,0 +1,99 @@
+#pragma once
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+//background thread releasing memory handed off by its owner
+//job is called repeatedly, every call does a bounded amount of work and returns true when the job is complete
+//owner calls pause() before touching resources shared with jobs, the thread stops at the end of the current step
+//pauses nest, jobs continue when every pause() got its resume()
+struct ReclaimQueue
+{
+	using Job_t = std::function<bool()>;
+
+	ReclaimQueue() : worker([this]() { run(); }) {}
+	ReclaimQueue(const ReclaimQueue&) = delete;
+	ReclaimQueue& operator=(const ReclaimQueue&) = delete;
+	~ReclaimQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			pauses = 0;
+		}
+		wake.notify_all();
+		worker.join();
+	}
+
+	//returns number of jobs waiting, including the new one
+	size_t push(Job_t job)
+	{
+		size_t length;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back(std::move(job));
+			length = jobs.size();
+		}
+		wake.notify_all();
+		return length;
+	}
+	void pause()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		++pauses;
+		step_done.wait(lock, [this]() { return !busy; });
+	}
+	void resume()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--pauses;
+		}
+		wake.notify_all();
+	}
+	void wait_empty()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		step_done.wait(lock, [this]() { return jobs.empty() && !busy; });
+	}
+	size_t size()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return jobs.size();
+	}
+
+protected:
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;)
+		{
+			wake.wait(lock, [this]() { return (stop || 0 == pauses) && (stop || !jobs.empty()); });
+			//remaining jobs are completed before the thread exits
+			if (jobs.empty()) return;
+			busy = true;
+			Job_t & job = jobs.front();
+			lock.unlock();
+			const bool done = job();
+			lock.lock();
+			if (done) jobs.pop_front();
+			busy = false;
+			step_done.notify_all();
+		}
+	}
+	std::mutex				mutex;
+	std::condition_variable	wake, step_done;
+	std::deque<Job_t>		jobs;
+	int						pauses = 0;
+	bool					busy = false, stop = false;
+	std::thread				worker;		//declared last, started when everything else is ready
+};
+
+struct ReclaimQueuePause
+{
+	ReclaimQueuePause(ReclaimQueue* q) : queue(q) { if (queue) queue->pause(); }
+	~ReclaimQueuePause() { if (queue) queue->resume(); }
+	ReclaimQueue *queue;
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//root statistics exchanged by processes searching the same position, mapped read-write by all of them
+//file : header, one slot per process, slot 0 belongs to the coordinator which merges the others
+//every process writes only its own slot, sequence counter lets readers skip a slot caught in the middle of an update
+#pragma pack (push,1)
+struct SharedRootStatsHeader
+{
+	char		magic[4];
+	uint32_t	version;
+	uint32_t	num_slots;
+	uint32_t	max_moves;
+};
+struct SharedRootMove
+{
+	float		value[4];		//sum of backpropagated values, as in MoveNode
+	uint32_t	num_visited;
+	uint16_t	probability;	//MoveNode encoding, 65535 = 1.0
+	uint16_t	pad;
+};
+#pragma pack(pop)
+struct SharedRootSlot
+{
+	std::atomic<uint32_t>	sequence;	//odd while the owner writes the slot
+	uint32_t		num_moves;
+	uint64_t		key;			//64 bit state digest of the root (see hashStateWords), 0 = nothing published yet
+	uint32_t		num_visited;
+	uint32_t		num_publishes;
+	SharedRootMove	moves[1];		//max_moves will follow
+};
+
+struct SharedRootStats
+{
+	static const uint32_t Version = 1;
+	static const uint32_t MaxMoves = 256;	//StateNode::numMoves is 8 bit
+	static constexpr char Magic[4] = { 'M','C','T','S' };
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "sequence counter is shared between processes");
+
+	static size_t slotBytes() { return (offsetof(SharedRootSlot, moves) + MaxMoves * sizeof(SharedRootMove) + 63) & ~size_t(63); }
+	static size_t fileBytes(uint32_t num_slots) { return 64 + num_slots * slotBytes(); }
+
+	//first process creates the file, the others wait until its header is written
+	SharedRootStats(const std::string& filename, uint32_t num_slots)
+	{
+		create(filename, num_slots);
+		for (int attempt = 0; !isComplete(filename, num_slots); ++attempt)
+		{
+			if (attempt == 500) throw "invalid_file_format";
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		file = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_write);
+		region = boost::interprocess::mapped_region(file, boost::interprocess::read_write);
+		base = static_cast<uint8_t*>(region.get_address());
+		this->num_slots = num_slots;
+	}
+	SharedRootStats(const SharedRootStats&) = delete;
+	SharedRootStats& operator=(const SharedRootStats&) = delete;
+
+	//file left by an earlier run is kept, slots keyed by another state are ignored by readers
+	static bool create(const std::string& filename, uint32_t num_slots)
+	{
+		FILE* f = std::fopen(filename.c_str(), "wbx");
+		if (!f) return false;
+		std::vector<char> zeros(fileBytes(num_slots), 0);
+		std::fwrite(zeros.data(), 1, zeros.size(), f);
+		std::fflush(f);
+		//header goes last, it marks the file as complete
+		SharedRootStatsHeader header{ {}, Version, num_slots, MaxMoves };
+		std::copy(Magic, Magic + 4, header.magic);
+		std::fseek(f, 0, SEEK_SET);
+		std::fwrite(&header, sizeof(header), 1, f);
+		std::fclose(f);
+		return true;
+	}
+
+	void publish(uint32_t slot_idx, uint64_t key, uint32_t num_visited, const SharedRootMove* moves, uint32_t num_moves)
+	{
+		auto & slot = this->slot(slot_idx);
+		const uint32_t seq = slot.sequence.load(std::memory_order_relaxed);
+		slot.sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.key = key;
+		slot.num_visited = num_visited;
+		slot.num_moves = std::min(num_moves, MaxMoves);
+		std::memcpy(slot.moves, moves, slot.num_moves * sizeof(SharedRootMove));
+		++slot.num_publishes;
+		slot.sequence.store(seq + 2, std::memory_order_release);
+	}
+	//consistent copy of the slot, false when it holds another state or its owner keeps writing it
+	bool read(uint32_t slot_idx, uint64_t key, uint32_t& num_visited, std::vector<SharedRootMove>& moves) const
+	{
+		const auto & slot = this->slot(slot_idx);
+		for (int attempt = 0; attempt < 100; ++attempt)
+		{
+			const uint32_t seq = slot.sequence.load(std::memory_order_acquire);
+			if (seq & 1) {
+				std::this_thread::yield();
+				continue;
+			}
+			if (slot.key != key) return false;
+			num_visited = slot.num_visited;
+			moves.resize(std::min(slot.num_moves, MaxMoves));
+			std::memcpy(moves.data(), slot.moves, moves.size() * sizeof(SharedRootMove));
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.sequence.load(std::memory_order_relaxed) == seq) return true;
+		}
+		return false;
+	}
+	uint32_t numPublishes(uint32_t slot_idx) const { return slot(slot_idx).num_publishes; }
+	uint32_t size() const { return num_slots; }
+
+protected:
+	//false while the creator writes the file, file of another layout throws
+	static bool isComplete(const std::string& filename, uint32_t num_slots)
+	{
+		std::ifstream in(filename, std::ios::binary);
+		SharedRootStatsHeader header;
+		if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || !std::equal(Magic, Magic + 4, header.magic)) return false;
+		if (header.version != Version || header.num_slots != num_slots || header.max_moves != MaxMoves) throw "invalid_file_format";
+		in.seekg(0, std::ios::end);
+		return size_t(in.tellg()) == fileBytes(num_slots);
+	}
+	SharedRootSlot& slot(uint32_t slot_idx) const { return *reinterpret_cast<SharedRootSlot*>(base + 64 + slot_idx * slotBytes()); }
+
+	boost::interprocess::file_mapping	file;
+	boost::interprocess::mapped_region	region;
+	uint8_t		*base = nullptr;
+	uint32_t	num_slots = 0;
+};
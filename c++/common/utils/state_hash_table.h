@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+//64 bit digest of the words returned by IGameRules::GetStateHash
+inline uint64_t hashStateWords(const uint32_t* words, size_t size)
+{
+	//FNV-1a over 32 bit words followed by murmur3 finalizer
+	uint64_t h = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; ++i) {
+		h = (h ^ words[i]) * 0x100000001b3ull;
+	}
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+//open addressing hash table with linear probing, maps state digest to node pointer stored inline
+//erase uses backward shift instead of tombstones, so lookups do not degrade after many deletions
+template <typename T>
+struct StateHashTable
+{
+	struct Entry
+	{
+		uint64_t	key;
+		T			*value;		//nullptr marks empty slot
+	};
+
+	StateHashTable(size_t initial_capacity = 1024)
+	{
+		size_t capacity = 16;
+		while (capacity < initial_capacity) capacity <<= 1;
+		entries.assign(capacity, Entry{ 0, nullptr });
+		mask = capacity - 1;
+	}
+
+	//digests may collide, is_equal confirms the candidate really holds the searched state
+	template <typename Pred>
+	T* find(uint64_t key, Pred is_equal)
+	{
+		++num_lookups;
+		for (size_t idx = key & mask;; idx = (idx + 1) & mask)
+		{
+			++num_probes;
+			const Entry & e = entries[idx];
+			if (nullptr == e.value) return nullptr;
+			if (e.key == key && is_equal(e.value)) return e.value;
+		}
+	}
+
+	void insert(uint64_t key, T* value)
+	{
+		if (2 * (num_entries + 1) > entries.size()) {
+			grow();
+		}
+		place(key, value);
+		++num_entries;
+	}
+
+	bool erase(uint64_t key, const T* value)
+	{
+		size_t hole = key & mask;
+		for (;; hole = (hole + 1) & mask)
+		{
+			if (nullptr == entries[hole].value) return false;
+			if (entries[hole].value == value) break;
+		}
+		for (size_t idx = (hole + 1) & mask; nullptr != entries[idx].value; idx = (idx + 1) & mask)
+		{
+			//entry may fill the hole only if its home slot does not lie between the hole and entry's current slot
+			const size_t home = entries[idx].key & mask;
+			if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+				entries[hole] = entries[idx];
+				hole = idx;
+			}
+		}
+		entries[hole] = Entry{ 0, nullptr };
+		--num_entries;
+		return true;
+	}
+
+	void clear()
+	{
+		std::fill(entries.begin(), entries.end(), Entry{ 0, nullptr });
+		num_entries = 0;
+	}
+
+	size_t size() const				{ return num_entries; }
+	size_t capacity() const			{ return entries.size(); }
+	float load_factor() const		{ return float(num_entries) / entries.size(); }
+	float average_probe_length() const { return num_lookups > 0 ? float(num_probes) / num_lookups : 0.0f; }
+	void reset_stats()				{ num_lookups = num_probes = 0; }
+
+protected:
+	void place(uint64_t key, T* value)
+	{
+		size_t idx = key & mask;
+		while (nullptr != entries[idx].value) {
+			idx = (idx + 1) & mask;
+		}
+		entries[idx] = Entry{ key, value };
+	}
+	void grow()
+	{
+		std::vector<Entry> old(entries.size() * 2, Entry{ 0, nullptr });
+		old.swap(entries);
+		mask = entries.size() - 1;
+		for (const auto & e : old) {
+			if (e.value) place(e.key, e.value);
+		}
+	}
+	std::vector<Entry> entries;
+	size_t mask;
+	size_t num_entries = 0;
+	size_t num_lookups = 0, num_probes = 0;
+};
@@ -0,0 +1,251 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <tuple>
+#include <type_traits>
+#include "GameRules.h"
+#include "GamePlayer.h"
+
+//MCTS bound at compile time to one rules class, instantiated inside the rules library
+//rules class is final, so move generation, ApplyMove and state release are direct calls the compiler can inline
+//plain UCT : one node appended per simulation, uniform random rollout, tree is rebuilt for every move
+//move probabilities weight the selection like in MC::Player, tree is not shared between threads
+namespace MC
+{
+	struct StaticSearchConfig
+	{
+		int			PlayerNumber = 0;
+		int			NumberOfPlayers = 2;
+		int			MaxPlayoutDepth = 20;
+		float		EERatio = 1.0f;
+		unsigned long seed = 1234;
+		int			MoveSimLimit = 0;		//0 : move is limited by MoveTimeLimit
+		float		MoveTimeLimit = 1.0f;	//seconds
+		std::string	EvalFcn;
+		std::string	Name = "static_mcts";
+	};
+
+	template <class Rules>
+	struct StaticSearch
+	{
+		static_assert(std::is_final<Rules>::value, "rules class must be final, otherwise calls stay virtual");
+
+		struct Node
+		{
+			GameState*	state;			//null until the node is reached first time
+			MoveList*	moveList;		//null for terminal states
+			uint32_t	firstChild;		//children of a node are contiguous
+			uint16_t	numChildren;
+			uint16_t	moveIdx;		//move in parent's list
+			uint32_t	numVisited;
+			float		probability;
+			float		value[4];		//sum of backpropagated values
+		};
+
+		StaticSearch(Rules& rules, const StaticSearchConfig& cfg) :
+			m_rules(rules), m_cfg(cfg), m_generator(cfg.seed), m_eval_function(rules.CreateEvalFunction(cfg.EvalFcn)) {}
+		~StaticSearch() { clear(); }
+
+		void start(const GameState* pks)
+		{
+			clear();
+			m_nodes.push_back(Node{ m_rules.CopyGameState(pks), nullptr, 0, 0, 0, 0, 1.0f, {} });
+			expand(0);
+		}
+		void simulate()
+		{
+			m_path.clear();
+			uint32_t ni = 0;
+			m_path.push_back(ni);
+			while (m_nodes[ni].numChildren > 0)
+			{
+				const int player = m_rules.GetCurrentPlayer(m_nodes[ni].state);
+				const uint32_t ci = selectChild(m_nodes[ni], player);
+				m_path.push_back(ci);
+				if (!m_nodes[ci].state)
+				{
+					Move* move = std::get<0>(m_rules.GetMoveFromList(m_nodes[ni].moveList, m_nodes[ci].moveIdx));
+					m_nodes[ci].state = m_rules.ApplyMove(m_nodes[ni].state, move, player);
+					expand(ci);
+					ni = ci;
+					break;
+				}
+				ni = ci;
+			}
+			int score[4] = { 0,0,0,0 };
+			rollout(m_nodes[ni].state, m_cfg.MaxPlayoutDepth - int(m_path.size()), score);
+			for (auto idx : m_path)
+			{
+				auto & node = m_nodes[idx];
+				++node.numVisited;
+				for (int i = 0; i < m_cfg.NumberOfPlayers; ++i) node.value[i] += score[i] / 100.0f;
+			}
+		}
+		//most visited root move
+		int bestMoveIdx() const
+		{
+			const auto & root = m_nodes[0];
+			uint32_t best = root.firstChild;
+			for (uint32_t ci = root.firstChild; ci < root.firstChild + root.numChildren; ++ci) {
+				if (m_nodes[ci].numVisited > m_nodes[best].numVisited) best = ci;
+			}
+			return m_nodes[best].moveIdx;
+		}
+		const MoveList* rootMoves() const { return m_nodes[0].moveList; }
+		int rootNumMoves() const { return m_nodes[0].numChildren; }
+		size_t size() const { return m_nodes.size(); }
+
+		void clear()
+		{
+			for (auto & node : m_nodes)
+			{
+				if (node.moveList) m_rules.ReleaseMoveList(node.moveList);
+				if (node.state) m_rules.ReleaseGameState(node.state);
+			}
+			//capacity is kept, next move appends nodes without reallocation
+			m_nodes.clear();
+		}
+
+	protected:
+		void expand(uint32_t ni)
+		{
+			GameState* s = m_nodes[ni].state;
+			if (m_rules.IsTerminal(s)) return;
+			MoveList* ml = m_rules.GetPlayerLegalMoves(s, m_rules.GetCurrentPlayer(s));
+			const int num_moves = m_rules.GetNumMoves(ml);
+			m_nodes[ni].moveList = ml;
+			m_nodes[ni].firstChild = uint32_t(m_nodes.size());
+			m_nodes[ni].numChildren = uint16_t(num_moves);
+			for (int mi = 0; mi < num_moves; ++mi) {
+				m_nodes.push_back(Node{ nullptr, nullptr, 0, 0, uint16_t(mi), 0, std::get<1>(m_rules.GetMoveFromList(ml, mi)), {} });
+			}
+		}
+		//same score as UCB::scalarScore of MC::Player
+		uint32_t selectChild(const Node& node, int player) const
+		{
+			const float c_sqrt_log = m_cfg.EERatio * std::sqrt(std::log(1.0f + node.numVisited));
+			uint32_t best = node.firstChild;
+			float best_score = -1.0f;
+			for (uint32_t ci = node.firstChild; ci < node.firstChild + node.numChildren; ++ci)
+			{
+				const auto & child = m_nodes[ci];
+				const float oo_visited = 1.0f / (1.0f + child.numVisited);
+				const float score = child.value[player] * child.probability * oo_visited + c_sqrt_log * std::sqrt(oo_visited);
+				if (score > best_score) {
+					best_score = score;
+					best = ci;
+				}
+			}
+			return best;
+		}
+		void rollout(const GameState* s, int depth, int score[])
+		{
+			GameState* own = nullptr;
+			for (; depth > 0 && !m_rules.IsTerminal(s); --depth)
+			{
+				const int player = m_rules.GetCurrentPlayer(s);
+				MoveList* ml = m_rules.GetPlayerLegalMoves(s, player);
+				const int num_moves = m_rules.GetNumMoves(ml);
+				if (0 == num_moves) {
+					m_rules.ReleaseMoveList(ml);
+					break;
+				}
+				std::uniform_int_distribution<int> distribution(0, num_moves - 1);
+				GameState* ns = m_rules.ApplyMove(s, std::get<0>(m_rules.GetMoveFromList(ml, distribution(m_generator))), player);
+				m_rules.ReleaseMoveList(ml);
+				if (own) m_rules.ReleaseGameState(own);
+				s = own = ns;
+			}
+			if (m_rules.IsTerminal(s)) m_rules.Score(s, score);
+			else m_eval_function(s, score);
+			if (own) m_rules.ReleaseGameState(own);
+		}
+
+		Rules&						m_rules;
+		const StaticSearchConfig&	m_cfg;
+		std::vector<Node>			m_nodes;
+		std::vector<uint32_t>		m_path;
+		std::default_random_engine	m_generator;
+		EvalFunction_t				m_eval_function;
+	};
+
+	//exposes StaticSearch as IGamePlayer, rules libraries export it as createPlayer
+	//search keeps its own rules instance, selected move is allocated by rules set by the controller
+	template <class Rules>
+	struct StaticPlayer : IGamePlayer
+	{
+		StaticPlayer(const StaticSearchConfig& cfg, std::unique_ptr<Rules> rules) :
+			m_cfg(cfg), m_rules(std::move(rules)), m_search(*m_rules, m_cfg)
+		{
+			m_simulations_per_sec.Rounding(3).Prefix('K');
+			m_num_runs_per_move.Rounding(2);
+		}
+		void startNewGame(GameState*) override {}
+		void endGame(int, GameResult) override {}
+		void setGameRules(IGameRules* gr) override { m_shared_rules = gr; }
+		MoveList* selectMove(GameState* pks) override
+		{
+			const auto t0 = std::chrono::steady_clock::now();
+			const auto time_limit = std::chrono::duration<float>(m_cfg.MoveTimeLimit);
+			m_search.start(pks);
+			int runs = 0;
+			//single move needs no search
+			while (m_search.rootNumMoves() > 1)
+			{
+				m_search.simulate();
+				++runs;
+				if (m_cfg.MoveSimLimit > 0) {
+					if (runs >= m_cfg.MoveSimLimit) break;
+				}
+				else if (0 == runs % 64 && std::chrono::steady_clock::now() - t0 >= time_limit) break;
+			}
+			const auto useconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+			if (useconds > 0) {
+				m_simulations_per_sec.insert(long(runs * 1000000ll / useconds));
+			}
+			m_num_runs_per_move.insert(runs);
+			MoveList* selected = m_shared_rules->SelectMoveFromList(m_search.rootMoves(), m_search.bestMoveIdx());
+			m_search.clear();
+			return selected;
+		}
+		NamedMetrics_t getGameStats() override
+		{
+			NamedMetrics_t nm;
+			nm["runs_per_move"] = m_num_runs_per_move;
+			nm["simulations_per_sec"] = m_simulations_per_sec;
+			return nm;
+		}
+		std::string getName() override { return m_cfg.Name; }
+		void resetStats() override
+		{
+			m_simulations_per_sec.values.clear();
+			m_num_runs_per_move.values.clear();
+		}
+		void release() override { delete this; }
+
+		StaticSearchConfig		m_cfg;
+		std::unique_ptr<Rules>	m_rules;
+		StaticSearch<Rules>		m_search;
+		IGameRules*				m_shared_rules = nullptr;
+		Histogram<long>			m_simulations_per_sec;
+		Histogram<long>			m_num_runs_per_move;
+	};
+
+	inline StaticSearchConfig makeStaticSearchConfig(int player_number, const PlayerConfig_t& pc)
+	{
+		StaticSearchConfig cfg;
+		cfg.PlayerNumber = player_number;
+		cfg.NumberOfPlayers = pc.get_optional<int>("number_of_players").get_value_or(2);
+		cfg.MaxPlayoutDepth = pc.get_optional<int>("playout_depth").get_value_or(20);
+		cfg.EERatio = pc.get_optional<float>("explore_exploit_ratio").get_value_or(1.0f);
+		cfg.seed = pc.get_optional<unsigned long>("random_seed").get_value_or(unsigned(std::chrono::steady_clock::now().time_since_epoch().count()));
+		cfg.MoveSimLimit = pc.get_optional<int>("move_sim_limit").get_value_or(0);
+		cfg.MoveTimeLimit = pc.get_optional<float>("move_time_limit").get_value_or(1.0f);
+		cfg.EvalFcn = pc.get_optional<std::string>("eval_function").get_value_or("");
+		cfg.Name = pc.get_optional<std::string>("fullname").get_value_or(pc.get_optional<std::string>("name").get_value_or("static_mcts"));
+		return cfg;
+	}
+}